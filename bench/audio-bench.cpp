@@ -0,0 +1,182 @@
+// Audio copy benchmark
+//
+// Drives the planar <-> MXL slice copy loops used by the input plugin
+// (capture_loop_audio) and the output plugin (write_audio_samples,
+// write_wide_audio_samples, write_silence_samples) against an in-memory ring that stands in for an MXL
+// continuous flow: one channel buffer of `ring_length` samples per channel,
+// `stride` bytes apart, with slices split in two where the range wraps.
+//
+// Usage: mxl-audio-bench [--min-ms N] [--ring-length N] [--filter TEXT]
+
+#include "bench-util.h"
+#include "mxl-audio.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+// OBS delivers at most this many planes per audio packet
+constexpr uint32_t OBS_MAX_CHANNELS = 8;
+
+const uint32_t CHANNEL_COUNTS[] = {1, 2, 8, 16, 64};
+const uint32_t SAMPLE_AMOUNTS[] = {32, 64, 128, 256, 480, 512, 1024, 2048, 4096};
+
+enum wrap_position {
+    WRAP_NONE,   // slice starts at the beginning of the ring
+    WRAP_MIDDLE, // slice is split into two equal fragments
+    WRAP_EDGE,   // only the first sample lies before the wrap
+};
+
+const char *wrap_name(wrap_position wrap)
+{
+    switch (wrap) {
+    case WRAP_NONE: return "none";
+    case WRAP_MIDDLE: return "middle";
+    case WRAP_EDGE: return "edge";
+    }
+    return "?";
+}
+
+struct ring {
+    std::vector<uint8_t> storage;
+    size_t length = 0;
+    size_t stride = 0;
+    uint32_t channels = 0;
+};
+
+ring make_ring(uint32_t channels, size_t length)
+{
+    ring r;
+    r.length = length;
+    // Channel buffers are page aligned, as in the MXL shared-memory layout
+    r.stride = (length * sizeof(float) + 4095) & ~static_cast<size_t>(4095);
+    r.channels = channels;
+    r.storage.resize(r.stride * channels);
+    bench_fill_random(r.storage, 42);
+    return r;
+}
+
+size_t start_offset(const ring &r, size_t samples, wrap_position wrap)
+{
+    switch (wrap) {
+    case WRAP_NONE: return 0;
+    case WRAP_MIDDLE: return r.length - samples / 2;
+    case WRAP_EDGE: return r.length - 1;
+    }
+    return 0;
+}
+
+// Equivalent of mxlFlowReaderGetSamples / mxlFlowWriterOpenSamples on the ring
+mxl_audio_mutable_slice slice_at(ring &r, size_t offset, size_t samples)
+{
+    mxl_audio_mutable_slice slice = {};
+    size_t first = std::min(samples, r.length - offset);
+    slice.fragments[0].pointer = r.storage.data() + offset * sizeof(float);
+    slice.fragments[0].size = first * sizeof(float);
+    if (samples > first) {
+        slice.fragments[1].pointer = r.storage.data();
+        slice.fragments[1].size = (samples - first) * sizeof(float);
+    }
+    slice.stride = r.stride;
+    slice.count = r.channels;
+    return slice;
+}
+
+mxl_audio_slice as_const(const mxl_audio_mutable_slice &slice)
+{
+    mxl_audio_slice view = {};
+    for (int frag = 0; frag < 2; ++frag) {
+        view.fragments[frag].pointer = slice.fragments[frag].pointer;
+        view.fragments[frag].size = slice.fragments[frag].size;
+    }
+    view.stride = slice.stride;
+    view.count = slice.count;
+    return view;
+}
+
+void print_result(const char *path, uint32_t channels, uint32_t samples, wrap_position wrap,
+                  uint32_t copied_channels, double ns)
+{
+    double samples_per_sec = static_cast<double>(samples) * 1e9 / ns;
+    double channel_samples_per_sec = samples_per_sec * copied_channels;
+    printf("%-8s %4u %6u %-7s %10.1f %12.1f %14.1f\n", path, channels, samples, wrap_name(wrap), ns,
+           samples_per_sec / 1e6, channel_samples_per_sec / 1e6);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const char *min_ms_arg = bench_arg(argc, argv, "--min-ms");
+    const char *ring_arg = bench_arg(argc, argv, "--ring-length");
+    const char *filter = bench_arg(argc, argv, "--filter");
+    uint64_t min_time_ns = (min_ms_arg ? strtoull(min_ms_arg, nullptr, 10) : 50) * 1000000ULL;
+    size_t ring_length = ring_arg ? strtoull(ring_arg, nullptr, 10) : 48000;
+    if (ring_length < 2 * SAMPLE_AMOUNTS[sizeof(SAMPLE_AMOUNTS) / sizeof(SAMPLE_AMOUNTS[0]) - 1]) {
+        fprintf(stderr, "--ring-length must hold at least two of the largest batches\n");
+        return 1;
+    }
+
+    printf("Ring length: %zu samples per channel\n", ring_length);
+    printf("%-8s %4s %6s %-7s %10s %12s %14s\n", "path", "ch", "batch", "wrap", "ns/call", "Msamples/s",
+           "Mch-samples/s");
+
+    const wrap_position wraps[] = {WRAP_NONE, WRAP_MIDDLE, WRAP_EDGE};
+    const char *paths[] = {"read", "write", "wide", "silence"};
+
+    for (const char *path : paths) {
+        if (filter && std::string(path).find(filter) == std::string::npos) {
+            continue;
+        }
+        std::string name(path);
+
+        for (uint32_t channels : CHANNEL_COUNTS) {
+            ring r = make_ring(channels, ring_length);
+
+            // Planar OBS-side buffers, sized for the largest batch
+            uint32_t planar_channels = std::min(channels, OBS_MAX_CHANNELS);
+            size_t max_samples = SAMPLE_AMOUNTS[sizeof(SAMPLE_AMOUNTS) / sizeof(SAMPLE_AMOUNTS[0]) - 1];
+            std::vector<std::vector<float>> planar(planar_channels, std::vector<float>(max_samples, 0.25f));
+            float *dst[OBS_MAX_CHANNELS] = {};
+            const float *src[OBS_MAX_CHANNELS] = {};
+            for (uint32_t ch = 0; ch < planar_channels; ++ch) {
+                dst[ch] = planar[ch].data();
+                src[ch] = planar[ch].data();
+            }
+
+            for (uint32_t samples : SAMPLE_AMOUNTS) {
+                for (wrap_position wrap : wraps) {
+                    mxl_audio_mutable_slice slice = slice_at(r, start_offset(r, samples, wrap), samples);
+                    double ns = 0;
+                    uint32_t copied_channels = channels;
+
+                    if (name == "read") {
+                        // The input plugin hands at most 8 channels to OBS
+                        mxl_audio_slice view = as_const(slice);
+                        copied_channels = planar_channels;
+                        ns = bench_measure([&] {
+                            mxl_audio_read_planar(view, dst, planar_channels, samples);
+                        }, 1000, min_time_ns);
+                    } else if (name == "write") {
+                        // Channels beyond the OBS planes are written as silence
+                        ns = bench_measure([&] {
+                            mxl_audio_write_planar(slice, src, planar_channels);
+                        }, 1000, min_time_ns);
+                    } else if (name == "wide") {
+                        // One OBS mixer per 8 channels, each into its own channel slots
+                        ns = bench_measure([&] {
+                            for (uint32_t first = 0; first < channels; first += planar_channels) {
+                                mxl_audio_write_channels(slice, first, src, planar_channels);
+                            }
+                        }, 1000, min_time_ns);
+                    } else {
+                        ns = bench_measure([&] {
+                            mxl_audio_write_silence(slice);
+                        }, 1000, min_time_ns);
+                    }
+                    print_result(path, channels, samples, wrap, copied_channels, ns);
+                }
+            }
+        }
+    }
+    return 0;
+}
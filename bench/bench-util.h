@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Shared helpers for the standalone benchmarks
+
+inline uint64_t bench_now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Deterministic pseudo-random fill so runs are comparable
+inline void bench_fill_random(std::vector<uint8_t> &buffer, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    for (auto &byte : buffer) {
+        byte = static_cast<uint8_t>(rng());
+    }
+}
+
+// Run `fn` until both `min_iterations` and `min_time_ns` are reached and
+// return the mean time per call in nanoseconds. One untimed warm-up call
+// brings the buffers into cache and faults in their pages.
+template <typename Fn>
+double bench_measure(Fn &&fn, uint32_t min_iterations, uint64_t min_time_ns)
+{
+    fn();
+    uint64_t iterations = 0;
+    uint64_t start = bench_now_ns();
+    uint64_t elapsed = 0;
+    do {
+        fn();
+        iterations++;
+        elapsed = bench_now_ns() - start;
+    } while (iterations < min_iterations || elapsed < min_time_ns);
+    return static_cast<double>(elapsed) / static_cast<double>(iterations);
+}
+
+// Parse "--name value" style options shared by the benchmarks
+inline const char *bench_arg(int argc, char **argv, const char *name)
+{
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (strcmp(argv[i], name) == 0) {
+            return argv[i + 1];
+        }
+    }
+    return nullptr;
+}
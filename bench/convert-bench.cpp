@@ -0,0 +1,320 @@
+// Pixel conversion benchmark
+//
+// Times the v210 packers (every OBS output format -> v210, output plugin),
+// the 8-bit UYVY packer (NV12/I420/I422 -> UYVY) and the v210 unpacker
+// (v210 -> RGBA, input plugin) for common broadcast resolutions and widths
+// that do not divide into 6-pixel groups. Every packer variant is
+// checked against the scalar reference before it is timed. For the best
+// variant it also compares clearing the whole destination before packing
+// with clearing only the line padding, and packing in row bands on a
+// persistent band pool (mxl-band-pool) with 2 and 4 threads or --threads N.
+// For the 8-bit 4:2:x formats it also times the main pack followed by a
+// 1/2 and 1/4 box downscale and pack of a proxy frame (mxl-downscale).
+//
+// Usage: mxl-convert-bench [--min-ms N] [--min-frames N] [--filter TEXT] [--threads N]
+
+#include "bench-util.h"
+#include "mxl-v210.h"
+#include "mxl-uyvy.h"
+#include "mxl-band-pool.h"
+#include "mxl-downscale.h"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+struct resolution {
+    const char *name;
+    uint32_t width;
+    uint32_t height;
+};
+
+const resolution RESOLUTIONS[] = {
+    {"720p", 1280, 720},
+    {"768p", 1366, 768},
+    {"1080p", 1920, 1080},
+    {"2160p", 3840, 2160},
+    {"DCI 4K", 4096, 2160},
+};
+
+struct source_frame {
+    std::vector<uint8_t> planes[3];
+    v210_source source = {};
+    size_t bytes = 0;
+};
+
+// Planes are allocated with a padded linesize, like OBS frames
+source_frame make_source(v210_source_format format, uint32_t width, uint32_t height)
+{
+    source_frame frame;
+    frame.source.format = format;
+    frame.source.width = width;
+    frame.source.height = height;
+
+    bool rgb = format == V210_SOURCE_RGBA || format == V210_SOURCE_BGRA;
+    bool wide = format == V210_SOURCE_P010 || format == V210_SOURCE_I010 ||
+                format == V210_SOURCE_P216 || format == V210_SOURCE_I210;
+    bool halved = format == V210_SOURCE_NV12 || format == V210_SOURCE_I420 ||
+                  format == V210_SOURCE_P010 || format == V210_SOURCE_I010;
+    uint32_t plane_count = v210_source_plane_count(format);
+    uint32_t sample_bytes = wide ? 2 : 1;
+    uint32_t chroma_width = format == V210_SOURCE_I444 ? width : (width + 1) / 2;
+
+    for (uint32_t i = 0; i < plane_count; i++) {
+        uint32_t row_bytes = rgb ? width * 4 : width * sample_bytes;
+        uint32_t rows = height;
+        if (i > 0) {
+            // NV12/P010/P216 carry both chroma samples in one plane
+            row_bytes = chroma_width * sample_bytes * (plane_count == 2 ? 2 : 1);
+            rows = halved ? (height + 1) / 2 : height;
+        }
+        uint32_t linesize = (row_bytes + 31) & ~31u;
+        frame.planes[i].resize(static_cast<size_t>(linesize) * rows);
+        frame.source.linesize[i] = linesize;
+        frame.bytes += static_cast<size_t>(row_bytes) * rows;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        bench_fill_random(frame.planes[i], 1234 + i);
+        frame.source.planes[i] = frame.planes[i].empty() ? nullptr : frame.planes[i].data();
+    }
+    return frame;
+}
+
+struct band_job {
+    const v210_source *source;
+    uint8_t *dst;
+    size_t dst_stride;
+    v210_isa isa;
+};
+
+void pack_band(void *context, uint32_t row_begin, uint32_t row_end)
+{
+    const band_job *job = static_cast<const band_job*>(context);
+    v210_pack_rows(*job->source, job->dst, job->dst_stride, job->isa, row_begin, row_end);
+}
+
+void print_result(const char *kernel, const resolution &res, const char *variant,
+                  double ns_per_frame, size_t bytes_moved, const char *note)
+{
+    double gbps = static_cast<double>(bytes_moved) / ns_per_frame;
+    printf("%-18s %-7s %5ux%-5u %-8s %12.0f %9.3f %8.2f  %s\n", kernel, res.name, res.width, res.height,
+           variant, ns_per_frame, ns_per_frame / 1e6, gbps, note);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const char *min_ms_arg = bench_arg(argc, argv, "--min-ms");
+    const char *min_frames_arg = bench_arg(argc, argv, "--min-frames");
+    const char *filter = bench_arg(argc, argv, "--filter");
+    uint64_t min_time_ns = (min_ms_arg ? strtoull(min_ms_arg, nullptr, 10) : 300) * 1000000ULL;
+    uint32_t min_frames = min_frames_arg ? static_cast<uint32_t>(strtoul(min_frames_arg, nullptr, 10)) : 10;
+
+    printf("Best variant on this CPU: %s\n", v210_isa_name(v210_best_isa()));
+    printf("%-18s %-7s %-11s %-8s %12s %9s %8s\n", "kernel", "res", "size", "variant", "ns/frame", "ms/frame", "GB/s");
+
+    const char *threads_arg = bench_arg(argc, argv, "--threads");
+    std::vector<uint32_t> band_threads = {2, 4};
+    if (threads_arg) {
+        band_threads = {static_cast<uint32_t>(strtoul(threads_arg, nullptr, 10))};
+    }
+    std::vector<std::unique_ptr<mxl_band_pool>> band_pools;
+    for (uint32_t threads : band_threads) {
+        band_pools.emplace_back(new mxl_band_pool());
+        band_pools.back()->start(threads);
+    }
+
+    int failures = 0;
+    const v210_source_format formats[] = {
+        V210_SOURCE_NV12, V210_SOURCE_I420, V210_SOURCE_I422, V210_SOURCE_I444,
+        V210_SOURCE_P010, V210_SOURCE_I010, V210_SOURCE_P216, V210_SOURCE_I210,
+        V210_SOURCE_RGBA, V210_SOURCE_BGRA,
+    };
+
+    for (const resolution &res : RESOLUTIONS) {
+        size_t v210_stride = v210_line_bytes(res.width);
+        size_t v210_size = v210_stride * res.height;
+        std::vector<uint8_t> reference(v210_size);
+        std::vector<uint8_t> packed(v210_size);
+
+        for (v210_source_format format : formats) {
+            std::string kernel = std::string(v210_source_format_name(format)) + "->v210";
+            if (filter && kernel.find(filter) == std::string::npos && strstr(res.name, filter) == nullptr) {
+                continue;
+            }
+
+            source_frame frame = make_source(format, res.width, res.height);
+            v210_pack(frame.source, reference.data(), v210_stride, V210_ISA_SCALAR);
+
+            for (int isa = 0; isa < V210_ISA_COUNT; isa++) {
+                v210_isa variant = static_cast<v210_isa>(isa);
+                if (!v210_isa_supported(variant)) {
+                    continue;
+                }
+
+                memset(packed.data(), 0xAA, packed.size());
+                v210_pack(frame.source, packed.data(), v210_stride, variant);
+                bool matches = memcmp(packed.data(), reference.data(), v210_size) == 0;
+                if (!matches) {
+                    failures++;
+                }
+
+                double ns = bench_measure([&] {
+                    v210_pack(frame.source, packed.data(), v210_stride, variant);
+                }, min_frames, min_time_ns);
+                print_result(kernel.c_str(), res, v210_isa_name(variant), ns,
+                             frame.bytes + v210_size, matches ? "" : "MISMATCH vs scalar");
+            }
+
+            // Full-buffer clear before packing (the old convert_to_v210) versus
+            // clearing only the line padding, into a grain-like buffer whose
+            // lines are padded to 128 bytes
+            v210_isa best = v210_best_isa();
+            size_t grain_stride = (v210_stride + 127) & ~static_cast<size_t>(127);
+            size_t grain_size = grain_stride * res.height;
+            std::vector<uint8_t> cleared(grain_size);
+            std::vector<uint8_t> padded(grain_size);
+
+            memset(cleared.data(), 0, grain_size);
+            v210_pack(frame.source, cleared.data(), grain_stride, best);
+            memset(padded.data(), 0xAA, grain_size);
+            v210_pack(frame.source, padded.data(), grain_stride, best);
+            v210_clear_padding(padded.data(), grain_stride, res.width, res.height, grain_size);
+            bool matches = memcmp(padded.data(), cleared.data(), grain_size) == 0;
+            if (!matches) {
+                failures++;
+            }
+
+            double memset_ns = bench_measure([&] {
+                memset(cleared.data(), 0, grain_size);
+                v210_pack(frame.source, cleared.data(), grain_stride, best);
+            }, min_frames, min_time_ns);
+            print_result((kernel + " +memset").c_str(), res, v210_isa_name(best), memset_ns,
+                         frame.bytes + 2 * grain_size, "");
+
+            double padding_ns = bench_measure([&] {
+                v210_pack(frame.source, padded.data(), grain_stride, best);
+                v210_clear_padding(padded.data(), grain_stride, res.width, res.height, grain_size);
+            }, min_frames, min_time_ns);
+            char note[64];
+            snprintf(note, sizeof(note), "%s%.0f%% of +memset", matches ? "" : "MISMATCH vs memset, ",
+                     100.0 * padding_ns / memset_ns);
+            print_result((kernel + " +pad").c_str(), res, v210_isa_name(best), padding_ns,
+                         frame.bytes + grain_size, note);
+
+            // 8-bit UYVY flows: a byte interleave instead of the 10-bit pack
+            if (uyvy_source_supported(format)) {
+                size_t uyvy_stride = uyvy_line_bytes(res.width);
+                std::vector<uint8_t> uyvy(uyvy_stride * res.height);
+                uyvy_pack_rows(frame.source, uyvy.data(), uyvy_stride, 0, res.height);
+                bool uyvy_matches = true;
+                for (uint32_t y = 0; y < res.height && uyvy_matches; y++) {
+                    const uint8_t *luma = frame.source.planes[0] + static_cast<size_t>(y) * frame.source.linesize[0];
+                    for (uint32_t x = 0; x < res.width; x++) {
+                        if (uyvy[y * uyvy_stride + 2 * x + 1] != luma[x]) {
+                            uyvy_matches = false;
+                            break;
+                        }
+                    }
+                }
+                if (!uyvy_matches) {
+                    failures++;
+                }
+
+                double uyvy_ns = bench_measure([&] {
+                    uyvy_pack_rows(frame.source, uyvy.data(), uyvy_stride, 0, res.height);
+                }, min_frames, min_time_ns);
+                std::string uyvy_kernel = std::string(v210_source_format_name(format)) + "->UYVY";
+                print_result(uyvy_kernel.c_str(), res, "simd", uyvy_ns, frame.bytes + uyvy.size(),
+                             uyvy_matches ? "" : "MISMATCH vs source luma");
+            }
+
+            // Main pack plus the proxy flow's downscale and pack, as the output
+            // runs them in one pass over the frame
+            for (uint32_t factor : {2u, 4u}) {
+                if (!downscale_supported(format)) {
+                    break;
+                }
+                uint32_t proxy_width = downscale_dim(res.width, factor);
+                uint32_t proxy_height = downscale_dim(res.height, factor);
+                std::vector<uint8_t> proxy_planes(downscale_frame_size(format, proxy_width, proxy_height));
+                downscale_frame proxy = {};
+                downscale_frame_init(proxy, format, proxy_width, proxy_height, proxy_planes.data());
+                v210_source proxy_source = downscale_frame_source(proxy, format);
+                size_t proxy_stride = v210_line_bytes(proxy_width);
+                std::vector<uint8_t> proxy_packed(proxy_stride * proxy_height);
+
+                // Every proxy luma sample is the rounded mean of its block
+                downscale_rows(frame.source, factor, proxy, 0, proxy_height);
+                bool proxy_matches = true;
+                for (uint32_t y = 0; y < proxy_height && proxy_matches; y++) {
+                    for (uint32_t x = 0; x < proxy_width; x++) {
+                        uint32_t sum = 0;
+                        for (uint32_t dy = 0; dy < factor; dy++) {
+                            const uint8_t *line = frame.source.planes[0] +
+                                                  static_cast<size_t>(y * factor + dy) * frame.source.linesize[0];
+                            for (uint32_t dx = 0; dx < factor; dx++) {
+                                sum += line[x * factor + dx];
+                            }
+                        }
+                        uint32_t mean = (sum + factor * factor / 2) / (factor * factor);
+                        if (proxy.planes[0][static_cast<size_t>(y) * proxy.linesize[0] + x] != mean) {
+                            proxy_matches = false;
+                            break;
+                        }
+                    }
+                }
+                if (!proxy_matches) {
+                    failures++;
+                }
+
+                double proxy_ns = bench_measure([&] {
+                    v210_pack(frame.source, packed.data(), v210_stride, best);
+                    downscale_rows(frame.source, factor, proxy, 0, proxy_height);
+                    v210_pack(proxy_source, proxy_packed.data(), proxy_stride, best);
+                }, min_frames, min_time_ns);
+                std::string proxy_kernel = kernel + " +proxy/" + std::to_string(factor);
+                print_result(proxy_kernel.c_str(), res, v210_isa_name(best), proxy_ns,
+                             frame.bytes + v210_size + proxy_packed.size(),
+                             proxy_matches ? "" : "MISMATCH vs box mean");
+            }
+
+            for (const std::unique_ptr<mxl_band_pool> &pool : band_pools) {
+                band_job job = {&frame.source, packed.data(), v210_stride, best};
+                memset(packed.data(), 0xAA, packed.size());
+                pool->run(res.height, pack_band, &job);
+                bool band_matches = memcmp(packed.data(), reference.data(), v210_size) == 0;
+                if (!band_matches) {
+                    failures++;
+                }
+
+                double band_ns = bench_measure([&] {
+                    pool->run(res.height, pack_band, &job);
+                }, min_frames, min_time_ns);
+                std::string band_kernel = kernel + " x" + std::to_string(pool->thread_count());
+                print_result(band_kernel.c_str(), res, v210_isa_name(best), band_ns, frame.bytes + v210_size,
+                             band_matches ? "" : "MISMATCH vs scalar");
+            }
+        }
+
+        if (filter && strstr("v210->RGBA", filter) == nullptr && strstr(res.name, filter) == nullptr) {
+            continue;
+        }
+
+        size_t rgba_stride = static_cast<size_t>(res.width) * 4;
+        std::vector<uint8_t> rgba(rgba_stride * res.height);
+        double ns = bench_measure([&] {
+            v210_unpack_to_rgba(reference.data(), v210_stride, res.width, res.height, rgba.data(), rgba_stride);
+        }, min_frames, min_time_ns);
+        print_result("v210->RGBA", res, "scalar", ns, v210_size + rgba.size(), "");
+    }
+
+    if (failures) {
+        fprintf(stderr, "%d variant(s) did not match the scalar reference\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,638 @@
+// End-to-end loopback harness
+//
+// Creates a temporary MXL domain (on /dev/shm by default) and runs a video and
+// an audio stream through it without the OBS UI:
+//   - writer side: the output plugin's mxl_output_data (pooled frame copy,
+//     process_video_frame converting into the grain, write_audio_samples)
+//     fed with synthetic, timestamped frames at the configured rate;
+//   - reader side: the input plugin's read loops (grain/sample fetch, resync on
+//     TOO_LATE, v210 -> RGBA and slice copy through the shared kernels).
+// The writer records the commit time of every grain index (audio: every
+// AUDIO_GRANULE samples); the reader looks it up on delivery. The harness
+// reports commit-to-delivery latency percentiles, drops and CPU per thread.
+// The reader also checks the luma of each grain's last line against the
+// source, so a stride mismatch between writer and reader (a sheared picture)
+// fails the run; use a width that is not a multiple of 48, e.g. 1280, to
+// exercise padded grain lines.
+//
+// Usage: mxl-loopback [--seconds N] [--width N] [--height N] [--fps N]
+//                     [--format nv12|i420] [--slices N] [--audio-channels N]
+//                     [--sample-amount N] [--warmup-ms N] [--domain PATH]
+//                     [--keep-domain] [--verbose]
+
+#include "bench-util.h"
+#include "mxl-audio.h"
+#include "mxl-output.h"
+#include "mxl-v210.h"
+#include <mxl/time.h>
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+namespace {
+// Commit times are kept for this many recent grains / audio granules
+constexpr size_t COMMIT_TABLE_SIZE = 1 << 14;
+// Audio commits are tracked per this many samples
+constexpr uint64_t AUDIO_GRANULE = 64;
+// OBS delivers audio in packets of this many frames
+constexpr uint32_t AUDIO_PACKET_FRAMES = 1024;
+// Same as the input plugin's read delay behind the flow head
+constexpr uint64_t READ_DELAY_NS = 40'000'000ULL;
+
+bool verbose_log = false;
+
+void log_handler(int level, const char *format, va_list args, void *)
+{
+    if (level > LOG_WARNING && !verbose_log) {
+        return;
+    }
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+}
+
+uint64_t thread_cpu_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Commit time per index, written by the writer thread and read by the reader.
+// A slot is valid only if its stored key matches the index being looked up.
+class commit_table {
+public:
+    commit_table()
+    {
+        for (size_t i = 0; i < COMMIT_TABLE_SIZE; i++) {
+            keys[i].store(UINT64_MAX, std::memory_order_relaxed);
+            times[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void record(uint64_t key, uint64_t time_ns)
+    {
+        size_t slot = key % COMMIT_TABLE_SIZE;
+        keys[slot].store(UINT64_MAX, std::memory_order_relaxed);
+        times[slot].store(time_ns, std::memory_order_release);
+        keys[slot].store(key, std::memory_order_release);
+    }
+
+    bool lookup(uint64_t key, uint64_t &time_ns) const
+    {
+        size_t slot = key % COMMIT_TABLE_SIZE;
+        if (keys[slot].load(std::memory_order_acquire) != key) {
+            return false;
+        }
+        time_ns = times[slot].load(std::memory_order_acquire);
+        return keys[slot].load(std::memory_order_acquire) == key;
+    }
+
+private:
+    std::atomic<uint64_t> keys[COMMIT_TABLE_SIZE];
+    std::atomic<uint64_t> times[COMMIT_TABLE_SIZE];
+};
+
+struct thread_usage {
+    uint64_t cpu_ns = 0;
+    uint64_t wall_ns = 0;
+};
+
+struct stream_result {
+    // Writer side
+    uint64_t submitted = 0;
+    uint64_t committed = 0;
+    uint64_t write_failures = 0;
+    uint64_t first_index = UINT64_MAX;
+    uint64_t last_index = 0;
+    thread_usage writer;
+
+    // Reader side
+    uint64_t delivered = 0;
+    uint64_t invalid = 0;
+    uint64_t too_late = 0;
+    uint64_t skipped = 0;
+    uint64_t timeouts = 0;
+    uint64_t unmatched = 0;
+    // Video grains whose last line does not match the source luma
+    uint64_t sheared = 0;
+    std::vector<uint64_t> latency_ns;
+    thread_usage reader;
+};
+
+struct options {
+    uint32_t seconds = 10;
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    uint32_t fps = 50;
+    enum video_format format = VIDEO_FORMAT_NV12;
+    // Slice batches per video grain (VideoSliceBatches)
+    uint32_t slices = 1;
+    uint32_t audio_channels = 2;
+    uint32_t audio_rate = 48000;
+    uint32_t sample_amount = 480;
+    uint32_t warmup_ms = 1000;
+    std::string domain;
+    bool keep_domain = false;
+};
+
+uint64_t index_delay(const mxlRational &rate, uint64_t delay_ns)
+{
+    if (rate.numerator <= 0 || rate.denominator <= 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>((static_cast<__uint128_t>(delay_ns) * rate.numerator) /
+                                 (static_cast<uint64_t>(rate.denominator) * 1000000000ULL));
+}
+
+// Source luma plane exactly as video_writer fills it
+uint32_t source_luma_linesize(const options &opt)
+{
+    return (opt.width + 31) & ~31u;
+}
+
+// Compares the first (up to) 6 luma samples of the grain's last line with the
+// 8-bit source; rows further down are the first to shear on a wrong stride
+bool last_line_matches(const uint8_t *payload, size_t stride, const std::vector<uint8_t> &luma,
+                       const options &opt)
+{
+    if (opt.height < 2) {
+        return true;
+    }
+    uint32_t row = opt.height - 1;
+    const uint8_t *src = luma.data() + static_cast<size_t>(row) * source_luma_linesize(opt);
+    const uint8_t *group = payload + static_cast<size_t>(row) * stride;
+    uint32_t words[4];
+    memcpy(words, group, sizeof(words));
+    const uint32_t samples[6] = {
+        (words[0] >> 10) & 0x3FF, words[1] & 0x3FF, (words[1] >> 20) & 0x3FF,
+        (words[2] >> 10) & 0x3FF, words[3] & 0x3FF, (words[3] >> 20) & 0x3FF,
+    };
+    for (uint32_t x = 0; x < std::min(opt.width, 6u); x++) {
+        if (samples[x] != static_cast<uint32_t>(src[x]) << 2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void sleep_until_ns(uint64_t target_ns)
+{
+    uint64_t now = os_gettime_ns();
+    if (target_ns > now) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(target_ns - now));
+    }
+}
+
+void video_writer(mxl_output_data &out, const options &opt, std::atomic<bool> &running,
+                  commit_table &commits, stream_result &result)
+{
+    uint64_t cpu_start = thread_cpu_ns();
+    uint64_t wall_start = os_gettime_ns();
+
+    // Synthetic source planes with OBS-like padded linesizes
+    uint32_t linesize[MAX_AV_PLANES] = {};
+    std::vector<uint8_t> planes[3];
+    uint8_t *plane_ptrs[MAX_AV_PLANES] = {};
+    uint32_t chroma_height = (opt.height + 1) / 2;
+    linesize[0] = source_luma_linesize(opt);
+    planes[0].resize(static_cast<size_t>(linesize[0]) * opt.height);
+    if (opt.format == VIDEO_FORMAT_NV12) {
+        linesize[1] = linesize[0];
+        planes[1].resize(static_cast<size_t>(linesize[1]) * chroma_height);
+    } else {
+        linesize[1] = linesize[2] = (((opt.width + 1) / 2) + 31) & ~31u;
+        planes[1].resize(static_cast<size_t>(linesize[1]) * chroma_height);
+        planes[2].resize(static_cast<size_t>(linesize[2]) * chroma_height);
+    }
+    for (int i = 0; i < 3; i++) {
+        bench_fill_random(planes[i], 7 + i);
+        plane_ptrs[i] = planes[i].empty() ? nullptr : planes[i].data();
+    }
+
+    const uint64_t interval_ns = 1000000000ULL / opt.fps;
+    uint64_t next_ns = os_gettime_ns();
+    for (uint64_t frame = 0; running.load(std::memory_order_relaxed); frame++) {
+        sleep_until_ns(next_ns);
+        next_ns += interval_ns;
+
+        // Frame number in the first luma samples so every frame differs
+        memcpy(planes[0].data(), &frame, sizeof(frame));
+
+        // Same steps as the queued path of mxl_output_raw_video plus output_loop
+        video_frame_ptr video_frame = out.video_pool.acquire();
+        struct video_frame source = {};
+        for (int i = 0; i < 3; i++) {
+            source.data[i] = plane_ptrs[i];
+            source.linesize[i] = linesize[i];
+        }
+        video_frame_copy(&video_frame->planes, &source, opt.format, opt.height);
+        video_frame->timestamp = os_gettime_ns();
+        result.submitted++;
+
+        if (!out.process_video_frame(std::move(video_frame))) {
+            result.write_failures++;
+            continue;
+        }
+
+        uint64_t index = out.last_grain_index;
+        commits.record(index, os_gettime_ns());
+        result.committed++;
+        result.first_index = std::min(result.first_index, index);
+        result.last_index = std::max(result.last_index, index);
+    }
+
+    result.writer.cpu_ns = thread_cpu_ns() - cpu_start;
+    result.writer.wall_ns = os_gettime_ns() - wall_start;
+}
+
+void audio_writer(mxl_output_data &out, const options &opt, std::atomic<bool> &running,
+                  commit_table &commits, stream_result &result)
+{
+    uint64_t cpu_start = thread_cpu_ns();
+    uint64_t wall_start = os_gettime_ns();
+
+    std::vector<std::vector<float>> channels(std::min<uint32_t>(opt.audio_channels, MAX_AV_PLANES),
+                                             std::vector<float>(AUDIO_PACKET_FRAMES));
+    for (size_t ch = 0; ch < channels.size(); ch++) {
+        for (uint32_t i = 0; i < AUDIO_PACKET_FRAMES; i++) {
+            channels[ch][i] = 0.25f * std::sin(static_cast<float>(i * (ch + 1)) * 0.01f);
+        }
+    }
+
+    const uint64_t interval_ns = 1000000000ULL * AUDIO_PACKET_FRAMES / opt.audio_rate;
+    uint64_t next_ns = os_gettime_ns();
+    while (running.load(std::memory_order_relaxed)) {
+        sleep_until_ns(next_ns);
+        next_ns += interval_ns;
+
+        struct audio_data frames = {};
+        for (size_t ch = 0; ch < channels.size(); ch++) {
+            frames.data[ch] = reinterpret_cast<uint8_t*>(channels[ch].data());
+        }
+        frames.frames = AUDIO_PACKET_FRAMES;
+        frames.timestamp = os_gettime_ns();
+        result.submitted++;
+
+        if (out.audio_tracks.empty() || !out.write_audio_samples(out.audio_tracks.front(), &frames)) {
+            result.write_failures++;
+            continue;
+        }
+
+        uint64_t commit_ns = os_gettime_ns();
+        uint64_t end = out.audio_tracks.front().last_index_end;
+        uint64_t start = end - AUDIO_PACKET_FRAMES;
+        for (uint64_t granule = start / AUDIO_GRANULE; granule <= (end - 1) / AUDIO_GRANULE; granule++) {
+            commits.record(granule, commit_ns);
+        }
+        result.committed++;
+        result.first_index = std::min(result.first_index, start);
+        result.last_index = std::max(result.last_index, end - 1);
+    }
+
+    result.writer.cpu_ns = thread_cpu_ns() - cpu_start;
+    result.writer.wall_ns = os_gettime_ns() - wall_start;
+}
+
+uint64_t resync_index(mxlFlowReader reader, const mxlRational &rate, uint64_t delay)
+{
+    mxlFlowRuntimeInfo runtime_info = {};
+    if (mxlFlowReaderGetRuntimeInfo(reader, &runtime_info) == MXL_STATUS_OK) {
+        return runtime_info.headIndex > delay ? runtime_info.headIndex - delay : runtime_info.headIndex;
+    }
+    return mxlGetCurrentIndex(&rate);
+}
+
+void video_reader(mxlFlowReader reader, const options &opt, std::atomic<bool> &running,
+                  uint64_t measure_from_ns, const commit_table &commits, stream_result &result)
+{
+    uint64_t cpu_start = thread_cpu_ns();
+    uint64_t wall_start = os_gettime_ns();
+
+    mxlFlowInfo flow_info = {};
+    mxlFlowReaderGetInfo(reader, &flow_info);
+    const mxlRational rate = flow_info.config.common.grainRate;
+    const uint64_t delay = std::max<uint64_t>(1, index_delay(rate, READ_DELAY_NS));
+    const uint64_t frame_interval_ns = 1000000000ULL / opt.fps;
+
+    size_t rgba_stride = static_cast<size_t>(opt.width) * 4;
+    std::vector<uint8_t> rgba(rgba_stride * opt.height);
+    size_t line_bytes = v210_line_bytes(opt.width);
+    std::vector<uint8_t> luma(static_cast<size_t>(source_luma_linesize(opt)) * opt.height);
+    bench_fill_random(luma, 7);
+
+    uint64_t index = resync_index(reader, rate, delay);
+    while (running.load(std::memory_order_relaxed)) {
+        mxlGrainInfo grain_info = {};
+        uint8_t *payload = nullptr;
+        mxlStatus status = mxlFlowReaderGetGrain(reader, index, frame_interval_ns + 1000000, &grain_info, &payload);
+
+        if (status == MXL_STATUS_OK && payload && !(grain_info.flags & MXL_GRAIN_FLAG_INVALID) &&
+            grain_info.validSlices < grain_info.totalSlices) {
+            // Committed in slice batches and not complete yet
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue;
+        }
+        if (status == MXL_STATUS_OK && payload) {
+            if (grain_info.flags & MXL_GRAIN_FLAG_INVALID) {
+                result.invalid++;
+            } else {
+                // Grain lines may be padded beyond the packed line, as the
+                // writer lays them out
+                size_t v210_stride = std::max(line_bytes, static_cast<size_t>(grain_info.grainSize / opt.height));
+                if (line_bytes * opt.height > grain_info.grainSize) {
+                    result.sheared++;
+                } else {
+                    v210_unpack_to_rgba(payload, v210_stride, opt.width, opt.height, rgba.data(), rgba_stride);
+                    if (!last_line_matches(payload, v210_stride, luma, opt)) {
+                        result.sheared++;
+                    }
+                }
+                uint64_t delivered_ns = os_gettime_ns();
+                result.delivered++;
+
+                uint64_t commit_ns = 0;
+                if (!commits.lookup(index, commit_ns)) {
+                    result.unmatched++;
+                } else if (commit_ns >= measure_from_ns) {
+                    result.latency_ns.push_back(delivered_ns > commit_ns ? delivered_ns - commit_ns : 0);
+                }
+            }
+            index++;
+        } else if (status == MXL_ERR_TIMEOUT || status == MXL_ERR_OUT_OF_RANGE_TOO_EARLY) {
+            result.timeouts++;
+        } else if (status == MXL_ERR_OUT_OF_RANGE_TOO_LATE) {
+            result.too_late++;
+            uint64_t next = resync_index(reader, rate, delay);
+            if (next > index) {
+                result.skipped += next - index;
+            }
+            index = next;
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    result.reader.cpu_ns = thread_cpu_ns() - cpu_start;
+    result.reader.wall_ns = os_gettime_ns() - wall_start;
+}
+
+void audio_reader(mxlFlowReader reader, const options &opt, std::atomic<bool> &running,
+                  uint64_t measure_from_ns, const commit_table &commits, stream_result &result)
+{
+    uint64_t cpu_start = thread_cpu_ns();
+    uint64_t wall_start = os_gettime_ns();
+
+    mxlFlowInfo flow_info = {};
+    mxlFlowReaderGetInfo(reader, &flow_info);
+    const mxlRational rate = flow_info.config.common.grainRate;
+    const uint64_t delay = std::max<uint64_t>(index_delay(rate, READ_DELAY_NS), opt.sample_amount);
+
+    uint32_t channels = std::min<uint32_t>(opt.audio_channels, MAX_AV_PLANES);
+    std::vector<float> buffer(static_cast<size_t>(opt.sample_amount) * channels);
+    float *planes[MAX_AV_PLANES] = {};
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        planes[ch] = buffer.data() + static_cast<size_t>(ch) * opt.sample_amount;
+    }
+
+    uint64_t index = resync_index(reader, rate, delay);
+    while (running.load(std::memory_order_relaxed)) {
+        mxlWrappedMultiBufferSlice payload;
+        mxlStatus status = mxlFlowReaderGetSamples(reader, index, opt.sample_amount,
+                                                   mxlGetNsUntilIndex(index + opt.sample_amount, &rate),
+                                                   &payload);
+
+        if (status == MXL_STATUS_OK) {
+            mxl_audio_slice slice = {};
+            for (int frag = 0; frag < 2; ++frag) {
+                slice.fragments[frag].pointer = static_cast<const uint8_t*>(payload.base.fragments[frag].pointer);
+                slice.fragments[frag].size = payload.base.fragments[frag].size;
+            }
+            slice.stride = payload.stride;
+            slice.count = payload.count;
+            mxl_audio_read_planar(slice, planes, channels, opt.sample_amount);
+            uint64_t delivered_ns = os_gettime_ns();
+            result.delivered++;
+
+            // Latency of the newest sample in the batch
+            uint64_t commit_ns = 0;
+            if (!commits.lookup((index + opt.sample_amount - 1) / AUDIO_GRANULE, commit_ns)) {
+                result.unmatched++;
+            } else if (commit_ns >= measure_from_ns) {
+                result.latency_ns.push_back(delivered_ns > commit_ns ? delivered_ns - commit_ns : 0);
+            }
+            index += opt.sample_amount;
+        } else if (status == MXL_ERR_OUT_OF_RANGE_TOO_EARLY || status == MXL_ERR_TIMEOUT) {
+            result.timeouts++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        } else if (status == MXL_ERR_OUT_OF_RANGE_TOO_LATE) {
+            result.too_late++;
+            uint64_t next = resync_index(reader, rate, delay);
+            if (next > index) {
+                result.skipped += next - index;
+            }
+            index = next;
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    result.reader.cpu_ns = thread_cpu_ns() - cpu_start;
+    result.reader.wall_ns = os_gettime_ns() - wall_start;
+}
+
+double percentile_us(std::vector<uint64_t> &sorted, double p)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return static_cast<double>(sorted[rank]) / 1000.0;
+}
+
+void print_result(const char *name, const char *unit, stream_result &result)
+{
+    std::sort(result.latency_ns.begin(), result.latency_ns.end());
+    uint64_t span = result.committed ? result.last_index - result.first_index + 1 : 0;
+
+    printf("\n[%s]\n", name);
+    printf("  writer: submitted %" PRIu64 ", committed %" PRIu64 ", failed %" PRIu64 ", %s span %" PRIu64 "\n",
+           result.submitted, result.committed, result.write_failures, unit, span);
+    printf("  reader: delivered %" PRIu64 ", invalid %" PRIu64 ", too late %" PRIu64 " (skipped %" PRIu64
+           " %s), timeouts %" PRIu64 ", no commit record %" PRIu64 "\n",
+           result.delivered, result.invalid, result.too_late, result.skipped, unit, result.timeouts,
+           result.unmatched);
+    if (result.sheared) {
+        printf("  reader: %" PRIu64 " grains did not match the source (line stride mismatch)\n", result.sheared);
+    }
+    printf("  latency us (n=%zu): p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+           result.latency_ns.size(), percentile_us(result.latency_ns, 0.50), percentile_us(result.latency_ns, 0.90),
+           percentile_us(result.latency_ns, 0.99), percentile_us(result.latency_ns, 0.999),
+           percentile_us(result.latency_ns, 1.0));
+    auto cpu_line = [](const char *role, const thread_usage &usage) {
+        double pct = usage.wall_ns ? 100.0 * static_cast<double>(usage.cpu_ns) / static_cast<double>(usage.wall_ns) : 0.0;
+        printf("  %s cpu: %.1f ms (%.1f%% of one core)\n", role, static_cast<double>(usage.cpu_ns) / 1e6, pct);
+    };
+    cpu_line("writer", result.writer);
+    cpu_line("reader", result.reader);
+}
+
+bool parse_options(int argc, char **argv, options &opt)
+{
+    if (const char *v = bench_arg(argc, argv, "--seconds")) opt.seconds = static_cast<uint32_t>(atoi(v));
+    if (const char *v = bench_arg(argc, argv, "--width")) opt.width = static_cast<uint32_t>(atoi(v));
+    if (const char *v = bench_arg(argc, argv, "--height")) opt.height = static_cast<uint32_t>(atoi(v));
+    if (const char *v = bench_arg(argc, argv, "--fps")) opt.fps = static_cast<uint32_t>(atoi(v));
+    if (const char *v = bench_arg(argc, argv, "--slices")) opt.slices = static_cast<uint32_t>(atoi(v));
+    if (const char *v = bench_arg(argc, argv, "--audio-channels")) opt.audio_channels = static_cast<uint32_t>(atoi(v));
+    if (const char *v = bench_arg(argc, argv, "--sample-amount")) opt.sample_amount = static_cast<uint32_t>(atoi(v));
+    if (const char *v = bench_arg(argc, argv, "--warmup-ms")) opt.warmup_ms = static_cast<uint32_t>(atoi(v));
+    if (const char *v = bench_arg(argc, argv, "--domain")) opt.domain = v;
+    if (const char *v = bench_arg(argc, argv, "--format")) {
+        if (strcmp(v, "nv12") == 0) {
+            opt.format = VIDEO_FORMAT_NV12;
+        } else if (strcmp(v, "i420") == 0) {
+            opt.format = VIDEO_FORMAT_I420;
+        } else {
+            fprintf(stderr, "Unknown --format %s (nv12 or i420)\n", v);
+            return false;
+        }
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--keep-domain") == 0) opt.keep_domain = true;
+        if (strcmp(argv[i], "--verbose") == 0) verbose_log = true;
+    }
+    if (opt.width == 0 || opt.height == 0 || opt.fps == 0 || opt.sample_amount == 0 || opt.seconds == 0) {
+        fprintf(stderr, "Invalid options\n");
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    options opt;
+    if (!parse_options(argc, argv, opt)) {
+        return 1;
+    }
+    base_set_log_handler(log_handler, nullptr);
+
+    if (opt.domain.empty()) {
+        const char *base = std::filesystem::is_directory("/dev/shm") ? "/dev/shm" : "/tmp";
+        std::string templ = std::string(base) + "/mxl-loopback-XXXXXX";
+        if (!mkdtemp(templ.data())) {
+            perror("mkdtemp");
+            return 1;
+        }
+        opt.domain = templ;
+    }
+    printf("Domain: %s\n", opt.domain.c_str());
+    printf("Video: %ux%u @ %u fps (%s -> v210, %u slice batches), audio: %u ch @ %u Hz, read batch %u\n",
+           opt.width, opt.height, opt.fps, opt.format == VIDEO_FORMAT_NV12 ? "NV12" : "I420", opt.slices,
+           opt.audio_channels, opt.audio_rate, opt.sample_amount);
+
+    int rc = 0;
+    {
+        mxl_output_data out;
+        out.domain_path = opt.domain;
+        out.video_width = opt.width;
+        out.video_height = opt.height;
+        out.video_fps_num = opt.fps;
+        out.video_fps_den = 1;
+        out.video_format = opt.format;
+        out.video_slice_batches = opt.slices;
+        out.video_media_type = out.get_mxl_video_media_type(opt.format);
+        out.audio_enabled = opt.audio_channels > 0;
+        out.audio_sample_rate = opt.audio_rate;
+        out.audio_channel_count = opt.audio_channels;
+        out.video_pool.allocate(out.video_pool_size(), opt.format, opt.width, opt.height);
+
+        out.reset_time_base();
+        if (!out.initialize_mxl()) {
+            fprintf(stderr, "Failed to create the MXL flows\n");
+            rc = 1;
+        } else {
+            // The reader uses its own instance, as the input plugin would in another process
+            mxlInstance reader_instance = mxlCreateInstance(opt.domain.c_str(), "");
+            mxlFlowReader video_reader_handle = nullptr;
+            mxlFlowReader audio_reader_handle = nullptr;
+            if (!reader_instance ||
+                mxlCreateFlowReader(reader_instance, out.video_flow_id.c_str(), "", &video_reader_handle) != MXL_STATUS_OK ||
+                (out.audio_enabled &&
+                 mxlCreateFlowReader(reader_instance, out.audio_flow_id.c_str(), "", &audio_reader_handle) != MXL_STATUS_OK)) {
+                fprintf(stderr, "Failed to open the flow readers\n");
+                rc = 1;
+            } else {
+                commit_table *video_commits = new commit_table();
+                commit_table *audio_commits = new commit_table();
+                stream_result video_result;
+                stream_result audio_result;
+                std::atomic<bool> writers_running(true);
+                std::atomic<bool> readers_running(true);
+                uint64_t measure_from_ns = os_gettime_ns() + opt.warmup_ms * 1000000ULL;
+
+                std::thread threads[4];
+                threads[0] = std::thread(video_reader, video_reader_handle, std::cref(opt), std::ref(readers_running),
+                                         measure_from_ns, std::cref(*video_commits), std::ref(video_result));
+                threads[1] = std::thread(video_writer, std::ref(out), std::cref(opt), std::ref(writers_running),
+                                         std::ref(*video_commits), std::ref(video_result));
+                if (out.audio_enabled) {
+                    threads[2] = std::thread(audio_reader, audio_reader_handle, std::cref(opt), std::ref(readers_running),
+                                             measure_from_ns, std::cref(*audio_commits), std::ref(audio_result));
+                    threads[3] = std::thread(audio_writer, std::ref(out), std::cref(opt), std::ref(writers_running),
+                                             std::ref(*audio_commits), std::ref(audio_result));
+                }
+
+                std::this_thread::sleep_for(std::chrono::seconds(opt.seconds));
+                writers_running = false;
+                threads[1].join();
+                if (threads[3].joinable()) {
+                    threads[3].join();
+                }
+                // Let the readers drain what was committed last
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                readers_running = false;
+                threads[0].join();
+                if (threads[2].joinable()) {
+                    threads[2].join();
+                }
+
+                print_result("video", "grains", video_result);
+                if (video_result.sheared) {
+                    rc = 1;
+                }
+                if (out.audio_enabled) {
+                    print_result("audio", "samples", audio_result);
+                }
+                delete video_commits;
+                delete audio_commits;
+            }
+
+            if (video_reader_handle) {
+                mxlReleaseFlowReader(reader_instance, video_reader_handle);
+            }
+            if (audio_reader_handle) {
+                mxlReleaseFlowReader(reader_instance, audio_reader_handle);
+            }
+            if (reader_instance) {
+                mxlDestroyInstance(reader_instance);
+            }
+        }
+        out.cleanup_mxl();
+    }
+
+    if (!opt.keep_domain) {
+        std::error_code ec;
+        std::filesystem::remove_all(opt.domain, ec);
+    }
+    return rc;
+}
@@ -0,0 +1,83 @@
+#include "mxl-audio.h"
+#include <algorithm>
+#include <cstring>
+
+size_t mxl_audio_read_planar(const mxl_audio_slice &slice, float *const *dst,
+                             uint32_t channels, size_t frames)
+{
+    size_t copied = 0;
+    for (int frag = 0; frag < 2 && copied < frames; ++frag) {
+        const mxl_audio_fragment &fragment = slice.fragments[frag];
+        if (!fragment.pointer || fragment.size == 0) {
+            continue;
+        }
+
+        const size_t frames_to_copy = std::min(fragment.size / sizeof(float), frames - copied);
+        for (uint32_t ch = 0; ch < channels && ch < slice.count; ++ch) {
+            memcpy(dst[ch] + copied, fragment.pointer + ch * slice.stride, frames_to_copy * sizeof(float));
+        }
+        copied += frames_to_copy;
+    }
+    return copied;
+}
+
+void mxl_audio_write_planar(const mxl_audio_mutable_slice &slice,
+                            const float *const *src, size_t src_channels)
+{
+    size_t offset_samples = 0;
+    for (int frag = 0; frag < 2; ++frag) {
+        const mxl_audio_mutable_fragment &fragment = slice.fragments[frag];
+        if (!fragment.pointer || fragment.size == 0) {
+            continue;
+        }
+
+        const size_t fragment_samples = fragment.size / sizeof(float);
+        for (size_t ch = 0; ch < slice.count; ++ch) {
+            uint8_t *dst = fragment.pointer + ch * slice.stride;
+            if (ch < src_channels && src[ch]) {
+                memcpy(dst, src[ch] + offset_samples, fragment_samples * sizeof(float));
+            } else {
+                memset(dst, 0, fragment_samples * sizeof(float));
+            }
+        }
+        offset_samples += fragment_samples;
+    }
+}
+
+void mxl_audio_write_channels(const mxl_audio_mutable_slice &slice, size_t first_channel,
+                              const float *const *src, size_t channels)
+{
+    size_t end_channel = std::min(first_channel + channels, slice.count);
+    size_t offset_samples = 0;
+    for (int frag = 0; frag < 2; ++frag) {
+        const mxl_audio_mutable_fragment &fragment = slice.fragments[frag];
+        if (!fragment.pointer || fragment.size == 0) {
+            continue;
+        }
+
+        const size_t fragment_samples = fragment.size / sizeof(float);
+        for (size_t ch = first_channel; ch < end_channel; ++ch) {
+            uint8_t *dst = fragment.pointer + ch * slice.stride;
+            const float *channel_src = src ? src[ch - first_channel] : nullptr;
+            if (channel_src) {
+                memcpy(dst, channel_src + offset_samples, fragment_samples * sizeof(float));
+            } else {
+                memset(dst, 0, fragment_samples * sizeof(float));
+            }
+        }
+        offset_samples += fragment_samples;
+    }
+}
+
+void mxl_audio_write_silence(const mxl_audio_mutable_slice &slice)
+{
+    for (int frag = 0; frag < 2; ++frag) {
+        const mxl_audio_mutable_fragment &fragment = slice.fragments[frag];
+        if (!fragment.pointer || fragment.size == 0) {
+            continue;
+        }
+        for (size_t ch = 0; ch < slice.count; ++ch) {
+            memset(fragment.pointer + ch * slice.stride, 0, fragment.size);
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Copy helpers between planar float audio and MXL continuous-flow slices.
+//
+// An MXL ring slice for a sample range is split into up to two fragments (the
+// second one after the ring wraps). Channel `ch` of fragment `f` starts at
+// fragments[f].pointer + ch * stride and holds fragments[f].size bytes. The
+// views below mirror mxlWrappedMultiBufferSlice without depending on the SDK,
+// so the same loops run in the plugins and in bench/.
+
+struct mxl_audio_fragment {
+    const uint8_t *pointer;
+    size_t size;
+};
+
+struct mxl_audio_slice {
+    mxl_audio_fragment fragments[2];
+    size_t stride;
+    size_t count;
+};
+
+struct mxl_audio_mutable_fragment {
+    uint8_t *pointer;
+    size_t size;
+};
+
+struct mxl_audio_mutable_slice {
+    mxl_audio_mutable_fragment fragments[2];
+    size_t stride;
+    size_t count;
+};
+
+// Copy up to `frames` samples of each of the first `channels` slice channels
+// into planar `dst`. Channels missing from the slice are left untouched.
+// Returns the number of frames copied per channel.
+size_t mxl_audio_read_planar(const mxl_audio_slice &slice, float *const *dst,
+                             uint32_t channels, size_t frames);
+
+// Fill every slice channel from planar `src`; channels at or past
+// `src_channels`, or with a null source pointer, are written as silence.
+void mxl_audio_write_planar(const mxl_audio_mutable_slice &slice,
+                            const float *const *src, size_t src_channels);
+
+void mxl_audio_write_silence(const mxl_audio_mutable_slice &slice);
+
+// Fill slice channels [first_channel, first_channel + channels) from planar
+// `src`, leaving the other channels alone; a null `src` or source pointer
+// writes silence. Channels past the slice's count are skipped.
+void mxl_audio_write_channels(const mxl_audio_mutable_slice &slice, size_t first_channel,
+                              const float *const *src, size_t channels);
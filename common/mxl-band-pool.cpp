@@ -0,0 +1,114 @@
+#include "mxl-band-pool.h"
+#include <algorithm>
+
+mxl_band_pool::mxl_band_pool()
+    : generation(0)
+    , stopping(false)
+    , pending(0)
+    , job_fn(nullptr)
+    , job_context(nullptr)
+    , job_rows(0)
+{
+}
+
+mxl_band_pool::~mxl_band_pool()
+{
+    stop();
+}
+
+void mxl_band_pool::start(uint32_t threads)
+{
+    stop();
+    stopping = false;
+    for (uint32_t band = 1; band < threads; band++) {
+        workers.emplace_back(&mxl_band_pool::worker_loop, this, band, generation);
+    }
+}
+
+void mxl_band_pool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for (std::thread &worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+}
+
+void mxl_band_pool::band_range(uint32_t band, uint32_t &row_begin, uint32_t &row_end) const
+{
+    uint32_t bands = thread_count();
+    uint32_t row_pairs = (job_rows + 1) / 2;
+    row_begin = std::min(job_rows, static_cast<uint32_t>(2 * (static_cast<uint64_t>(row_pairs) * band / bands)));
+    row_end = std::min(job_rows, static_cast<uint32_t>(2 * (static_cast<uint64_t>(row_pairs) * (band + 1) / bands)));
+}
+
+void mxl_band_pool::run(uint32_t rows, mxl_band_fn fn, void *context)
+{
+    if (workers.empty()) {
+        fn(context, 0, rows);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job_fn = fn;
+        job_context = context;
+        job_rows = rows;
+        pending = static_cast<uint32_t>(workers.size());
+        generation++;
+    }
+    work_ready.notify_all();
+
+    uint32_t row_begin, row_end;
+    band_range(0, row_begin, row_end);
+    if (row_begin < row_end) {
+        fn(context, row_begin, row_end);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [this] { return pending == 0; });
+}
+
+void mxl_band_pool::worker_loop(uint32_t band, uint64_t seen_generation)
+{
+    // seen_generation comes from start(), so a run() issued before this
+    // thread first takes the lock is not missed
+    for (;;) {
+        std::unique_lock<std::mutex> lock(mutex);
+        work_ready.wait(lock, [&] { return stopping || generation != seen_generation; });
+        if (stopping) {
+            return;
+        }
+        seen_generation = generation;
+        mxl_band_fn fn = job_fn;
+        void *context = job_context;
+        uint32_t row_begin, row_end;
+        band_range(band, row_begin, row_end);
+        lock.unlock();
+
+        if (row_begin < row_end) {
+            fn(context, row_begin, row_end);
+        }
+
+        lock.lock();
+        if (--pending == 0) {
+            lock.unlock();
+            work_done.notify_one();
+        }
+    }
+}
+
+uint32_t mxl_band_auto_threads(uint32_t width, uint32_t height)
+{
+    if (static_cast<uint64_t>(width) * height <= 1920ULL * 1080ULL) {
+        return 1;
+    }
+    uint32_t hardware = std::thread::hardware_concurrency();
+    return std::max(1u, std::min(4u, hardware / 2));
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent worker threads that split a row range into bands. The calling
+// thread packs the first band itself, so a pool of N threads keeps N - 1
+// workers parked on a condition variable between frames. No libobs
+// dependency, so the benchmarks can drive it too.
+
+typedef void (*mxl_band_fn)(void *context, uint32_t row_begin, uint32_t row_end);
+
+class mxl_band_pool {
+public:
+    mxl_band_pool();
+    ~mxl_band_pool();
+
+    mxl_band_pool(const mxl_band_pool &) = delete;
+    mxl_band_pool &operator=(const mxl_band_pool &) = delete;
+
+    // `threads` counts the caller; 0 or 1 means run() stays on the caller
+    void start(uint32_t threads);
+    void stop();
+    uint32_t thread_count() const { return static_cast<uint32_t>(workers.size()) + 1; }
+
+    // Call fn(context, begin, end) for every band of [0, rows) and return
+    // once all of them are done. Band edges fall on even rows so 4:2:0
+    // chroma lines are not shared between bands. Not reentrant.
+    void run(uint32_t rows, mxl_band_fn fn, void *context);
+
+private:
+    void worker_loop(uint32_t band, uint64_t seen_generation);
+    void band_range(uint32_t band, uint32_t &row_begin, uint32_t &row_end) const;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable work_done;
+    uint64_t generation;
+    bool stopping;
+    uint32_t pending;
+
+    mxl_band_fn job_fn;
+    void *job_context;
+    uint32_t job_rows;
+};
+
+// Band threads for a frame size when the user leaves the count on automatic:
+// one up to 1080p, otherwise half the hardware threads, at most 4
+uint32_t mxl_band_auto_threads(uint32_t width, uint32_t height);
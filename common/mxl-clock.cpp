@@ -0,0 +1,66 @@
+#include "mxl-clock.h"
+#include <algorithm>
+
+mxl_clock_tracker::mxl_clock_tracker()
+    : max_slew_ppm(500)
+    , step_threshold_ns(5000000)
+    , step_samples(8)
+    , gain_shift(4)
+    , filtered(0)
+    , initial(0)
+    , has_offset(false)
+    , last_local_ns(0)
+    , outliers(0)
+{
+}
+
+void mxl_clock_tracker::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    has_offset.store(false, std::memory_order_release);
+    filtered.store(0, std::memory_order_release);
+    initial.store(0, std::memory_order_release);
+    last_local_ns = 0;
+    outliers = 0;
+}
+
+bool mxl_clock_tracker::update(uint64_t local_ns, uint64_t remote_ns)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    int64_t measured = static_cast<int64_t>(remote_ns - local_ns);
+    if (!has_offset.load(std::memory_order_relaxed)) {
+        filtered.store(measured, std::memory_order_release);
+        initial.store(measured, std::memory_order_release);
+        has_offset.store(true, std::memory_order_release);
+        last_local_ns = local_ns;
+        return false;
+    }
+
+    // Readings from several threads can arrive out of order; they still
+    // carry the offset, they just add no elapsed time for the slew budget
+    uint64_t elapsed_ns = local_ns > last_local_ns ? local_ns - last_local_ns : 0;
+    last_local_ns = std::max(last_local_ns, local_ns);
+
+    int64_t current = filtered.load(std::memory_order_relaxed);
+    int64_t error = measured - current;
+    if (error > step_threshold_ns || error < -step_threshold_ns) {
+        // A preempted reading is a one-off; a clock step keeps repeating
+        if (++outliers < step_samples) {
+            return false;
+        }
+        outliers = 0;
+        filtered.store(measured, std::memory_order_release);
+        return true;
+    }
+    outliers = 0;
+
+    int64_t correction = error / (int64_t(1) << gain_shift);
+    if (correction == 0) {
+        correction = error > 0 ? 1 : error < 0 ? -1 : 0;
+    }
+    int64_t slew_limit = static_cast<int64_t>(elapsed_ns / 1000000 * max_slew_ppm +
+                                              elapsed_ns % 1000000 * max_slew_ppm / 1000000);
+    correction = std::clamp(correction, -slew_limit, slew_limit);
+    filtered.store(current + correction, std::memory_order_release);
+    return false;
+}
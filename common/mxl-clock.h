@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// Follows the offset between a local clock (OBS's os_gettime_ns) and a
+// remote one (MXL's TAI time) from pairs of back-to-back readings. Single
+// readings jitter by the time between the two reads, and the clocks drift
+// apart by up to a few hundred ppm or step when a time service corrects
+// one of them. The filter moves its offset a fraction of the error per
+// sample, never faster than max_slew_ppm, so index mappings built on it
+// change smoothly; an error that stays beyond step_threshold_ns for
+// step_samples readings in a row is taken as a step. No libobs or MXL
+// dependency. Thread safe.
+
+class mxl_clock_tracker {
+public:
+    mxl_clock_tracker();
+
+    mxl_clock_tracker(const mxl_clock_tracker &) = delete;
+    mxl_clock_tracker &operator=(const mxl_clock_tracker &) = delete;
+
+    // Forget all readings; the next one sets the offset directly
+    void reset();
+
+    // One pair of readings, `local_ns` taken as close to `remote_ns` as
+    // possible. Returns true when the reading stepped the offset.
+    bool update(uint64_t local_ns, uint64_t remote_ns);
+
+    bool valid() const { return has_offset.load(std::memory_order_acquire); }
+    // Filtered remote - local
+    int64_t offset() const { return filtered.load(std::memory_order_acquire); }
+    // How far offset() moved since the first reading after reset()
+    int64_t drift() const { return offset() - initial.load(std::memory_order_acquire); }
+
+    // Tuning; set before the first update
+    uint32_t max_slew_ppm;
+    int64_t step_threshold_ns;
+    uint32_t step_samples;
+    // Fraction of the error applied per reading, as a right shift
+    uint32_t gain_shift;
+
+private:
+    std::mutex mutex;
+    std::atomic<int64_t> filtered;
+    std::atomic<int64_t> initial;
+    std::atomic<bool> has_offset;
+    uint64_t last_local_ns;
+    uint32_t outliers;
+};
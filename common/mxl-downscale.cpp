@@ -0,0 +1,257 @@
+#include "mxl-downscale.h"
+#include <vector>
+
+// SSE2 and NEON are part of the 64-bit baselines, so no runtime dispatch
+#if defined(__GNUC__) && defined(__x86_64__)
+#define MXL_DOWNSCALE_SSE2 1
+#include <emmintrin.h>
+#else
+#define MXL_DOWNSCALE_SSE2 0
+#endif
+
+#if defined(__aarch64__)
+#define MXL_DOWNSCALE_NEON 1
+#include <arm_neon.h>
+#else
+#define MXL_DOWNSCALE_NEON 0
+#endif
+
+namespace {
+// A block is summed in three steps on a row of 16-bit sums: add the
+// `factor` source lines, halve the row log2(factor) times by adding
+// neighbouring samples (or neighbouring Cb/Cr pairs for NV12 chroma), then
+// divide with rounding. The largest sum, 64 * 255, fits in 16 bits.
+
+void sum_lines(const uint8_t *src, size_t stride, uint32_t lines, uint32_t count, uint16_t *acc)
+{
+    uint32_t i = 0;
+#if MXL_DOWNSCALE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        __m128i lo = _mm_setzero_si128();
+        __m128i hi = _mm_setzero_si128();
+        for (uint32_t l = 0; l < lines; l++) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + l * stride + i));
+            lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+            hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i + 8), hi);
+    }
+#elif MXL_DOWNSCALE_NEON
+    for (; i + 16 <= count; i += 16) {
+        uint16x8_t lo = vdupq_n_u16(0);
+        uint16x8_t hi = vdupq_n_u16(0);
+        for (uint32_t l = 0; l < lines; l++) {
+            uint8x16_t v = vld1q_u8(src + l * stride + i);
+            lo = vaddw_u8(lo, vget_low_u8(v));
+            hi = vaddw_u8(hi, vget_high_u8(v));
+        }
+        vst1q_u16(acc + i, lo);
+        vst1q_u16(acc + i + 8, hi);
+    }
+#endif
+    for (; i < count; i++) {
+        uint16_t sum = 0;
+        for (uint32_t l = 0; l < lines; l++) {
+            sum = static_cast<uint16_t>(sum + src[l * stride + i]);
+        }
+        acc[i] = sum;
+    }
+}
+
+// acc[j] = acc[2j] + acc[2j + 1] (group 1) or the same over Cb/Cr pairs
+// (group 2) for the `count` output values. Writes trail reads, so it works
+// in place.
+void halve_row(uint16_t *acc, uint32_t count, uint32_t group)
+{
+    uint32_t j = 0;
+#if MXL_DOWNSCALE_SSE2
+    if (group == 1) {
+        const __m128i ones = _mm_set1_epi16(1);
+        for (; j + 8 <= count; j += 8) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + 2 * j));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + 2 * j + 8));
+            __m128i sums = _mm_packs_epi32(_mm_madd_epi16(a, ones), _mm_madd_epi16(b, ones));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + j), sums);
+        }
+    } else {
+        for (; j + 8 <= count; j += 8) {
+            __m128 a = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + 2 * j)));
+            __m128 b = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + 2 * j + 8)));
+            __m128i even = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            __m128i odd = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + j), _mm_add_epi16(even, odd));
+        }
+    }
+#elif MXL_DOWNSCALE_NEON
+    for (; j + 8 <= count; j += 8) {
+        uint16x8_t a = vld1q_u16(acc + 2 * j);
+        uint16x8_t b = vld1q_u16(acc + 2 * j + 8);
+        if (group == 1) {
+            vst1q_u16(acc + j, vpaddq_u16(a, b));
+        } else {
+            uint32x4_t a32 = vreinterpretq_u32_u16(a);
+            uint32x4_t b32 = vreinterpretq_u32_u16(b);
+            vst1q_u16(acc + j, vaddq_u16(vreinterpretq_u16_u32(vuzp1q_u32(a32, b32)),
+                                         vreinterpretq_u16_u32(vuzp2q_u32(a32, b32))));
+        }
+    }
+#endif
+    for (; j < count; j++) {
+        uint32_t pair = j / group;
+        uint32_t k = j % group;
+        acc[j] = static_cast<uint16_t>(acc[2 * pair * group + k] + acc[(2 * pair + 1) * group + k]);
+    }
+}
+
+void divide_row(const uint16_t *acc, uint32_t count, uint32_t shift, uint8_t *dst)
+{
+    const uint16_t round = static_cast<uint16_t>(1u << (shift - 1));
+    uint32_t i = 0;
+#if MXL_DOWNSCALE_SSE2
+    const __m128i bias = _mm_set1_epi16(static_cast<short>(round));
+    const __m128i count_shift = _mm_cvtsi32_si128(static_cast<int>(shift));
+    for (; i + 16 <= count; i += 16) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i + 8));
+        lo = _mm_srl_epi16(_mm_add_epi16(lo, bias), count_shift);
+        hi = _mm_srl_epi16(_mm_add_epi16(hi, bias), count_shift);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#elif MXL_DOWNSCALE_NEON
+    const uint16x8_t bias = vdupq_n_u16(round);
+    const int16x8_t right = vdupq_n_s16(static_cast<int16_t>(-static_cast<int>(shift)));
+    for (; i + 16 <= count; i += 16) {
+        uint16x8_t lo = vshlq_u16(vaddq_u16(vld1q_u16(acc + i), bias), right);
+        uint16x8_t hi = vshlq_u16(vaddq_u16(vld1q_u16(acc + i + 8), bias), right);
+        vst1q_u8(dst + i, vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = static_cast<uint8_t>((acc[i] + round) >> shift);
+    }
+}
+
+uint32_t log2_factor(uint32_t factor)
+{
+    return factor == 8 ? 3 : factor == 4 ? 2 : 1;
+}
+
+// One output line of `count` samples, `group` interleaved components each
+void downscale_line(const uint8_t *src, size_t src_stride, uint32_t factor, uint32_t count, uint32_t group,
+                    uint8_t *dst, std::vector<uint16_t> &acc)
+{
+    uint32_t src_count = count * factor;
+    acc.resize(src_count);
+    sum_lines(src, src_stride, factor, src_count, acc.data());
+    uint32_t steps = log2_factor(factor);
+    for (uint32_t step = 0, remaining = src_count; step < steps; step++) {
+        remaining /= 2;
+        halve_row(acc.data(), remaining, group);
+    }
+    divide_row(acc.data(), count, 2 * steps, dst);
+}
+
+size_t aligned_line(uint32_t bytes)
+{
+    return (static_cast<size_t>(bytes) + 63) & ~static_cast<size_t>(63);
+}
+} // namespace
+
+bool downscale_supported(v210_source_format format)
+{
+    return format == V210_SOURCE_NV12 || format == V210_SOURCE_I420 || format == V210_SOURCE_I422;
+}
+
+bool downscale_factor_valid(uint32_t factor)
+{
+    return factor == 2 || factor == 4 || factor == 8;
+}
+
+uint32_t downscale_dim(uint32_t size, uint32_t factor)
+{
+    return factor ? (size / factor) & ~1u : 0;
+}
+
+size_t downscale_frame_size(v210_source_format format, uint32_t width, uint32_t height)
+{
+    size_t luma = aligned_line(width) * height;
+    size_t chroma_height = format == V210_SOURCE_I422 ? height : height / 2;
+    if (format == V210_SOURCE_NV12) {
+        return luma + aligned_line(width) * chroma_height;
+    }
+    return luma + 2 * aligned_line(width / 2) * chroma_height;
+}
+
+void downscale_frame_init(downscale_frame &frame, v210_source_format format, uint32_t width, uint32_t height,
+                          uint8_t *buffer)
+{
+    frame = {};
+    frame.width = width;
+    frame.height = height;
+    size_t chroma_height = format == V210_SOURCE_I422 ? height : height / 2;
+    frame.linesize[0] = static_cast<uint32_t>(aligned_line(width));
+    frame.planes[0] = buffer;
+    if (format == V210_SOURCE_NV12) {
+        frame.linesize[1] = static_cast<uint32_t>(aligned_line(width));
+        frame.planes[1] = buffer + frame.linesize[0] * height;
+        return;
+    }
+    frame.linesize[1] = frame.linesize[2] = static_cast<uint32_t>(aligned_line(width / 2));
+    frame.planes[1] = buffer + frame.linesize[0] * height;
+    frame.planes[2] = frame.planes[1] + frame.linesize[1] * chroma_height;
+}
+
+v210_source downscale_frame_source(const downscale_frame &frame, v210_source_format format)
+{
+    v210_source source = {};
+    source.format = format;
+    source.width = frame.width;
+    source.height = frame.height;
+    for (int i = 0; i < 3; i++) {
+        source.planes[i] = frame.planes[i];
+        source.linesize[i] = frame.linesize[i];
+    }
+    return source;
+}
+
+bool downscale_rows(const v210_source &src, uint32_t factor, const downscale_frame &dst,
+                    uint32_t row_begin, uint32_t row_end)
+{
+    if (!downscale_supported(src.format) || !downscale_factor_valid(factor) || (row_begin & 1) ||
+        (row_end & 1 && row_end != dst.height) || dst.width * factor > src.width ||
+        dst.height * factor > src.height || !src.planes[0] || !src.planes[1] || !dst.planes[0] ||
+        !dst.planes[1]) {
+        return false;
+    }
+    bool nv12 = src.format == V210_SOURCE_NV12;
+    if (!nv12 && (!src.planes[2] || !dst.planes[2])) {
+        return false;
+    }
+
+    thread_local std::vector<uint16_t> acc;
+    row_end = row_end < dst.height ? row_end : dst.height;
+    for (uint32_t y = row_begin; y < row_end; y++) {
+        downscale_line(src.planes[0] + static_cast<size_t>(y) * factor * src.linesize[0], src.linesize[0],
+                       factor, dst.width, 1, dst.planes[0] + static_cast<size_t>(y) * dst.linesize[0], acc);
+    }
+
+    // 4:2:0 chroma rows pair up with luma rows; I422 keeps one per row
+    uint32_t chroma_begin = src.format == V210_SOURCE_I422 ? row_begin : row_begin / 2;
+    uint32_t chroma_end = src.format == V210_SOURCE_I422 ? row_end : row_end / 2;
+    uint32_t chroma_width = dst.width / 2;
+    for (uint32_t y = chroma_begin; y < chroma_end; y++) {
+        size_t src_offset = static_cast<size_t>(y) * factor;
+        if (nv12) {
+            downscale_line(src.planes[1] + src_offset * src.linesize[1], src.linesize[1], factor, chroma_width * 2,
+                           2, dst.planes[1] + static_cast<size_t>(y) * dst.linesize[1], acc);
+            continue;
+        }
+        for (int plane = 1; plane < 3; plane++) {
+            downscale_line(src.planes[plane] + src_offset * src.linesize[plane], src.linesize[plane], factor,
+                           chroma_width, 1, dst.planes[plane] + static_cast<size_t>(y) * dst.linesize[plane], acc);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "mxl-v210.h"
+#include <cstddef>
+#include <cstdint>
+
+// Box-filter downscaling of 8-bit YUV frames by 2, 4 or 8 in each direction,
+// for low-resolution companion (proxy) flows. The result stays in the
+// source's layout (NV12, I420 or I422), so the v210 and UYVY packers take it
+// as they are. Every output sample is the rounded mean of a factor x factor
+// block; the vector and scalar paths give identical results.
+
+struct downscale_frame {
+    uint8_t *planes[3];
+    uint32_t linesize[3];
+    uint32_t width;
+    uint32_t height;
+};
+
+bool downscale_supported(v210_source_format format);
+bool downscale_factor_valid(uint32_t factor);
+
+// Proxy size for one dimension: size / factor, rounded down to even
+uint32_t downscale_dim(uint32_t size, uint32_t factor);
+
+// Bytes needed for the planes of a `width` x `height` frame in `format`, with
+// lines padded to 64 bytes; downscale_frame_init lays the planes out in
+// `buffer`
+size_t downscale_frame_size(v210_source_format format, uint32_t width, uint32_t height);
+void downscale_frame_init(downscale_frame &frame, v210_source_format format, uint32_t width, uint32_t height,
+                          uint8_t *buffer);
+
+// Read-only view of `frame` for the packers
+v210_source downscale_frame_source(const downscale_frame &frame, v210_source_format format);
+
+// Fill rows [row_begin, row_end) of `dst` from `src`, whose format it shares.
+// Row bounds must be even so 4:2:0 chroma rows are not split. Returns false
+// for unsupported formats or factors, or when `src` is too small for `dst`.
+bool downscale_rows(const v210_source &src, uint32_t factor, const downscale_frame &dst,
+                    uint32_t row_begin, uint32_t row_end);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <util/profiler.h>
+#include "mxl-trace.h"
+
+// Scoped OBS profiler section that also feeds the ring-buffer tracer.
+//
+// The OBS profiler keys sections by pointer, so `name` must be a constant
+// with static storage (declare the names once per file, not inline literals
+// in different places).
+class mxl_profile_scope {
+public:
+    explicit mxl_profile_scope(const char *name)
+        : name(name)
+        , trace(name)
+    {
+        profile_start(name);
+    }
+
+    ~mxl_profile_scope()
+    {
+        profile_end(name);
+    }
+
+    mxl_profile_scope(const mxl_profile_scope &) = delete;
+    mxl_profile_scope &operator=(const mxl_profile_scope &) = delete;
+
+private:
+    const char *name;
+    mxl_trace_scope trace;
+};
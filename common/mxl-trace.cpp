@@ -0,0 +1,137 @@
+#include "mxl-trace.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+
+std::atomic<bool> mxl_trace_active(false);
+
+namespace {
+// 64k events (~2 MB) is a few seconds of every hot-path scope at 60 fps
+constexpr uint64_t TRACE_CAPACITY = 1 << 16;
+
+// Each slot is guarded by a sequence number: odd while being written, and
+// 2 * (event index + 1) once complete, so a dump never reads a torn event.
+struct trace_slot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<uint64_t> start_ns{0};
+    std::atomic<uint64_t> end_ns{0};
+    std::atomic<uint32_t> tid{0};
+};
+
+trace_slot trace_ring[TRACE_CAPACITY];
+std::atomic<uint64_t> trace_write_pos(0);
+std::atomic<uint32_t> trace_next_tid(1);
+
+uint32_t current_tid()
+{
+    thread_local uint32_t tid = trace_next_tid.fetch_add(1, std::memory_order_relaxed);
+    return tid;
+}
+
+struct trace_event {
+    const char *name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    uint32_t tid;
+};
+
+void write_json_string(std::ostream &out, const char *str)
+{
+    out << '"';
+    for (const char *c = str; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\';
+        }
+        out << *c;
+    }
+    out << '"';
+}
+} // namespace
+
+void mxl_trace_set_enabled(bool enabled)
+{
+    mxl_trace_active.store(enabled, std::memory_order_relaxed);
+}
+
+void mxl_trace_clear()
+{
+    for (auto &slot : trace_ring) {
+        slot.seq.store(0, std::memory_order_relaxed);
+    }
+    trace_write_pos.store(0, std::memory_order_relaxed);
+}
+
+uint64_t mxl_trace_now_ns()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void mxl_trace_record(const char *name, uint64_t start_ns, uint64_t end_ns)
+{
+    uint64_t pos = trace_write_pos.fetch_add(1, std::memory_order_relaxed);
+    trace_slot &slot = trace_ring[pos & (TRACE_CAPACITY - 1)];
+
+    slot.seq.store(2 * pos + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.end_ns.store(end_ns, std::memory_order_relaxed);
+    slot.tid.store(current_tid(), std::memory_order_relaxed);
+    slot.seq.store(2 * pos + 2, std::memory_order_release);
+}
+
+int64_t mxl_trace_dump(const std::string &path, const char *process_name)
+{
+    std::vector<trace_event> events;
+    events.reserve(TRACE_CAPACITY);
+
+    for (auto &slot : trace_ring) {
+        uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq == 0 || (seq & 1)) {
+            continue;
+        }
+        trace_event event;
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.start_ns = slot.start_ns.load(std::memory_order_relaxed);
+        event.end_ns = slot.end_ns.load(std::memory_order_relaxed);
+        event.tid = slot.tid.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq || !event.name) {
+            continue;
+        }
+        events.push_back(event);
+    }
+
+    std::sort(events.begin(), events.end(), [](const trace_event &a, const trace_event &b) {
+        return a.start_ns < b.start_ns;
+    });
+
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        return -1;
+    }
+
+    uint64_t origin_ns = events.empty() ? 0 : events.front().start_ns;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":";
+    write_json_string(out, process_name ? process_name : "mxl");
+    out << "}}";
+    char buf[96];
+    for (const auto &event : events) {
+        out << ",\n{\"name\":";
+        write_json_string(out, event.name);
+        snprintf(buf, sizeof(buf), ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                 event.tid,
+                 static_cast<double>(event.start_ns - origin_ns) / 1000.0,
+                 static_cast<double>(event.end_ns - event.start_ns) / 1000.0);
+        out << buf;
+    }
+    out << "\n]}\n";
+    out.close();
+
+    return out.fail() ? -1 : static_cast<int64_t>(events.size());
+}
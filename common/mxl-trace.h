@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Lightweight in-process tracer shared by both plugins.
+//
+// Completed scopes are written into a fixed-size ring buffer (the oldest
+// events are overwritten) and can be dumped on demand as Chrome trace JSON,
+// loadable in chrome://tracing or ui.perfetto.dev. This file has no libobs
+// dependency so it can also be linked into standalone tools.
+//
+// While tracing is disabled a scope costs a single relaxed atomic load.
+
+extern std::atomic<bool> mxl_trace_active;
+
+inline bool mxl_trace_enabled()
+{
+    return mxl_trace_active.load(std::memory_order_relaxed);
+}
+
+void mxl_trace_set_enabled(bool enabled);
+void mxl_trace_clear();
+uint64_t mxl_trace_now_ns();
+
+// Record a completed scope. `name` must outlive the tracer (use string literals).
+void mxl_trace_record(const char *name, uint64_t start_ns, uint64_t end_ns);
+
+// Write all buffered events to `path` as Chrome trace JSON. `process_name`
+// labels the trace process row. Returns the number of events written or -1.
+int64_t mxl_trace_dump(const std::string &path, const char *process_name);
+
+class mxl_trace_scope {
+public:
+    explicit mxl_trace_scope(const char *name)
+        : name(name)
+        , start_ns(mxl_trace_enabled() ? mxl_trace_now_ns() : 0)
+    {
+    }
+
+    ~mxl_trace_scope()
+    {
+        if (start_ns) {
+            mxl_trace_record(name, start_ns, mxl_trace_now_ns());
+        }
+    }
+
+    mxl_trace_scope(const mxl_trace_scope &) = delete;
+    mxl_trace_scope &operator=(const mxl_trace_scope &) = delete;
+
+private:
+    const char *name;
+    uint64_t start_ns;
+};
@@ -0,0 +1,162 @@
+#include "mxl-uyvy.h"
+#include <cstring>
+
+// SSE2 and NEON are part of the 64-bit baselines, so no runtime dispatch
+#if defined(__GNUC__) && defined(__x86_64__)
+#define MXL_UYVY_SSE2 1
+#include <emmintrin.h>
+#else
+#define MXL_UYVY_SSE2 0
+#endif
+
+#if defined(__aarch64__)
+#define MXL_UYVY_NEON 1
+#include <arm_neon.h>
+#else
+#define MXL_UYVY_NEON 0
+#endif
+
+namespace {
+// Interleaving 8 chroma pairs with 16 luma bytes gives 16 UYVY pixels:
+// byte i of the chroma vector followed by byte i of the luma vector.
+// Each returns the number of pixel pairs it packed; the scalar loops
+// below finish the row.
+uint32_t pack_pairs_planar_simd(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                                uint32_t pairs, uint8_t *dst)
+{
+    uint32_t j = 0;
+#if MXL_UYVY_SSE2
+    for (; j + 8 <= pairs; j += 8) {
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y_line + 2 * j));
+        __m128i u = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u_line + j));
+        __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v_line + j));
+        __m128i uv = _mm_unpacklo_epi8(u, v);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * j), _mm_unpacklo_epi8(uv, y));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * j + 16), _mm_unpackhi_epi8(uv, y));
+    }
+#elif MXL_UYVY_NEON
+    for (; j + 8 <= pairs; j += 8) {
+        uint8x8_t u = vld1_u8(u_line + j);
+        uint8x8_t v = vld1_u8(v_line + j);
+        uint8x16x2_t out;
+        out.val[0] = vcombine_u8(vzip1_u8(u, v), vzip2_u8(u, v));
+        out.val[1] = vld1q_u8(y_line + 2 * j);
+        vst2q_u8(dst + 4 * j, out);
+    }
+#endif
+    return j;
+}
+
+uint32_t pack_pairs_nv12_simd(const uint8_t *y_line, const uint8_t *uv_line, uint32_t pairs, uint8_t *dst)
+{
+    uint32_t j = 0;
+#if MXL_UYVY_SSE2
+    for (; j + 8 <= pairs; j += 8) {
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y_line + 2 * j));
+        __m128i uv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv_line + 2 * j));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * j), _mm_unpacklo_epi8(uv, y));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * j + 16), _mm_unpackhi_epi8(uv, y));
+    }
+#elif MXL_UYVY_NEON
+    for (; j + 8 <= pairs; j += 8) {
+        uint8x16x2_t out;
+        out.val[0] = vld1q_u8(uv_line + 2 * j);
+        out.val[1] = vld1q_u8(y_line + 2 * j);
+        vst2q_u8(dst + 4 * j, out);
+    }
+#endif
+    return j;
+}
+
+void pack_row_planar(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                     uint32_t width, uint8_t *dst)
+{
+    uint32_t pairs = width / 2;
+    for (uint32_t j = pack_pairs_planar_simd(y_line, u_line, v_line, pairs, dst); j < pairs; j++) {
+        dst[4 * j + 0] = u_line[j];
+        dst[4 * j + 1] = y_line[2 * j];
+        dst[4 * j + 2] = v_line[j];
+        dst[4 * j + 3] = y_line[2 * j + 1];
+    }
+    if (width & 1) {
+        uint8_t *tail = dst + 4 * pairs;
+        tail[0] = u_line[pairs];
+        tail[1] = y_line[2 * pairs];
+        tail[2] = v_line[pairs];
+        tail[3] = 16;
+    }
+}
+
+void pack_row_nv12(const uint8_t *y_line, const uint8_t *uv_line, uint32_t width, uint8_t *dst)
+{
+    uint32_t pairs = width / 2;
+    for (uint32_t j = pack_pairs_nv12_simd(y_line, uv_line, pairs, dst); j < pairs; j++) {
+        dst[4 * j + 0] = uv_line[2 * j];
+        dst[4 * j + 1] = y_line[2 * j];
+        dst[4 * j + 2] = uv_line[2 * j + 1];
+        dst[4 * j + 3] = y_line[2 * j + 1];
+    }
+    if (width & 1) {
+        uint8_t *tail = dst + 4 * pairs;
+        tail[0] = uv_line[2 * pairs];
+        tail[1] = y_line[2 * pairs];
+        tail[2] = uv_line[2 * pairs + 1];
+        tail[3] = 16;
+    }
+}
+} // namespace
+
+size_t uyvy_line_bytes(uint32_t width)
+{
+    return static_cast<size_t>((width + 1) / 2) * 4;
+}
+
+bool uyvy_source_supported(v210_source_format format)
+{
+    return format == V210_SOURCE_NV12 || format == V210_SOURCE_I420 || format == V210_SOURCE_I422;
+}
+
+bool uyvy_pack_rows(const v210_source &src, uint8_t *dst, size_t dst_stride,
+                    uint32_t row_begin, uint32_t row_end)
+{
+    if (!dst || src.width == 0 || src.height == 0 || !uyvy_source_supported(src.format)) {
+        return false;
+    }
+    bool nv12 = src.format == V210_SOURCE_NV12;
+    if (!src.planes[0] || !src.planes[1] || (!nv12 && !src.planes[2])) {
+        return false;
+    }
+
+    bool halved = src.format != V210_SOURCE_I422;
+    row_end = row_end < src.height ? row_end : src.height;
+    for (uint32_t y = row_begin; y < row_end; y++) {
+        const uint8_t *y_line = src.planes[0] + static_cast<size_t>(y) * src.linesize[0];
+        uint32_t chroma_y = halved ? y / 2 : y;
+        const uint8_t *u_line = src.planes[1] + static_cast<size_t>(chroma_y) * src.linesize[1];
+        if (nv12) {
+            pack_row_nv12(y_line, u_line, src.width, dst + y * dst_stride);
+        } else {
+            const uint8_t *v_line = src.planes[2] + static_cast<size_t>(chroma_y) * src.linesize[2];
+            pack_row_planar(y_line, u_line, v_line, src.width, dst + y * dst_stride);
+        }
+    }
+    return true;
+}
+
+void uyvy_clear_padding(uint8_t *dst, size_t dst_stride, uint32_t width, uint32_t height,
+                        size_t dst_size)
+{
+    size_t line_bytes = uyvy_line_bytes(width);
+    if (!dst || dst_stride < line_bytes) {
+        return;
+    }
+    if (dst_stride > line_bytes) {
+        for (uint32_t y = 0; y < height; y++) {
+            memset(dst + y * dst_stride + line_bytes, 0, dst_stride - line_bytes);
+        }
+    }
+    size_t used = dst_stride * height;
+    if (dst_size > used) {
+        memset(dst + used, 0, dst_size - used);
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "mxl-v210.h"
+#include <cstddef>
+#include <cstdint>
+
+// 8-bit 4:2:2 packing for flows whose consumers take UYVY directly
+// (Cb Y0 Cr Y1 per pixel pair, the RFC 4175 / NMOS video/raw YCbCr-4:2:2
+// 8-bit pgroup). Only byte interleaving, so the 8-bit YUV formats NV12,
+// I420 and I422 are accepted; the output asks OBS for I422 otherwise.
+// Sources are described with the same v210_source as the v210 packers.
+
+// Bytes of pixel data in one UYVY line (4 bytes per started pixel pair)
+size_t uyvy_line_bytes(uint32_t width);
+
+bool uyvy_source_supported(v210_source_format format);
+
+// Pack rows [row_begin, row_end) of `src` into UYVY lines of `dst_stride`
+// bytes; `dst` points at row 0. The missing right pixel of an odd width is
+// written as black. Returns false for unsupported formats or missing planes.
+bool uyvy_pack_rows(const v210_source &src, uint8_t *dst, size_t dst_stride,
+                    uint32_t row_begin, uint32_t row_end);
+
+// Same as v210_clear_padding for UYVY lines
+void uyvy_clear_padding(uint8_t *dst, size_t dst_stride, uint32_t width, uint32_t height,
+                        size_t dst_size);
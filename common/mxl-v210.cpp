@@ -0,0 +1,950 @@
+#include "mxl-v210.h"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MXL_V210_X86 1
+#include <immintrin.h>
+#else
+#define MXL_V210_X86 0
+#endif
+
+#if defined(__aarch64__)
+#define MXL_V210_NEON 1
+#include <arm_neon.h>
+#else
+#define MXL_V210_NEON 0
+#endif
+
+namespace {
+// Neutral chroma (128 << 2)
+constexpr uint32_t V210_CHROMA_NEUTRAL = 512;
+
+inline void store_le32(uint8_t *dst, uint32_t value)
+{
+    memcpy(dst, &value, sizeof(value));
+}
+
+inline uint32_t load_le32(const uint8_t *src)
+{
+    uint32_t value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+inline void store_group(uint8_t *dst,
+                        uint32_t y0, uint32_t y1, uint32_t y2, uint32_t y3, uint32_t y4, uint32_t y5,
+                        uint32_t u0, uint32_t u1, uint32_t u2,
+                        uint32_t v0, uint32_t v1, uint32_t v2)
+{
+    store_le32(dst + 0, u0 | (y0 << 10) | (v0 << 20));
+    store_le32(dst + 4, y1 | (u1 << 10) | (y2 << 20));
+    store_le32(dst + 8, v1 | (y3 << 10) | (u2 << 20));
+    store_le32(dst + 12, y4 | (v2 << 10) | (y5 << 20));
+}
+
+// Pack one line of 8-bit 4:2:x samples starting at pixel `x` (a multiple of 6).
+// Chroma sample j covers pixels 2j and 2j+1 and is read from
+// u[j * chroma_step] / v[j * chroma_step], which covers both planar (step 1)
+// and interleaved NV12 (step 2, v = u + 1) layouts. The vector packers use
+// this for the groups at the end of a line they cannot load safely.
+void pack_row_8bit_scalar(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                          uint32_t chroma_step, uint32_t x, uint32_t width, uint8_t *dst_line)
+{
+    uint8_t *dst = dst_line + (x / 6) * 16;
+    for (; x + 6 <= width; x += 6, dst += 16) {
+        const uint8_t *u = u_line + (x / 2) * chroma_step;
+        const uint8_t *v = v_line + (x / 2) * chroma_step;
+        store_group(dst,
+                    y_line[x + 0] << 2, y_line[x + 1] << 2, y_line[x + 2] << 2,
+                    y_line[x + 3] << 2, y_line[x + 4] << 2, y_line[x + 5] << 2,
+                    u[0] << 2, u[chroma_step] << 2, u[2 * chroma_step] << 2,
+                    v[0] << 2, v[chroma_step] << 2, v[2 * chroma_step] << 2);
+    }
+
+    if (x < width) {
+        // Partial last group: black luma and neutral chroma past the edge
+        uint32_t ys[6];
+        uint32_t us[3];
+        uint32_t vs[3];
+        for (uint32_t i = 0; i < 6; ++i) {
+            ys[i] = (x + i < width) ? (y_line[x + i] << 2) : 0;
+        }
+        for (uint32_t j = 0; j < 3; ++j) {
+            uint32_t chroma_x = x / 2 + j;
+            bool inside = chroma_x * 2 < width;
+            us[j] = inside ? (u_line[chroma_x * chroma_step] << 2) : V210_CHROMA_NEUTRAL;
+            vs[j] = inside ? (v_line[chroma_x * chroma_step] << 2) : V210_CHROMA_NEUTRAL;
+        }
+        store_group(dst, ys[0], ys[1], ys[2], ys[3], ys[4], ys[5],
+                    us[0], us[1], us[2], vs[0], vs[1], vs[2]);
+    }
+}
+
+// Row packer: y/u/v point at the start of the line's samples (for NV12, v = u + 1)
+typedef void (*pack_row_fn)(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                            uint32_t width, uint8_t *dst);
+
+void pack_row_nv12_scalar(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                          uint32_t width, uint8_t *dst)
+{
+    pack_row_8bit_scalar(y_line, u_line, v_line, 2, 0, width, dst);
+}
+
+void pack_row_i420_scalar(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                          uint32_t width, uint8_t *dst)
+{
+    pack_row_8bit_scalar(y_line, u_line, v_line, 1, 0, width, dst);
+}
+
+// Scalar packer for the remaining formats, from pixel `x` (a multiple of 6).
+// luma(x) returns the 10-bit Y of pixel x; chroma(j, cb, cr) the 10-bit Cb/Cr
+// for pixels 2j and 2j+1, and is only called when pixel 2j exists. Tail
+// handling matches pack_row_8bit_scalar.
+template <typename Luma, typename Chroma>
+inline void pack_row_generic(uint32_t x, uint32_t width, uint8_t *dst_line, Luma luma, Chroma chroma)
+{
+    uint8_t *dst = dst_line + (x / 6) * 16;
+    for (; x + 6 <= width; x += 6, dst += 16) {
+        uint32_t u0, u1, u2, v0, v1, v2;
+        chroma(x / 2, u0, v0);
+        chroma(x / 2 + 1, u1, v1);
+        chroma(x / 2 + 2, u2, v2);
+        store_group(dst, luma(x), luma(x + 1), luma(x + 2), luma(x + 3), luma(x + 4), luma(x + 5),
+                    u0, u1, u2, v0, v1, v2);
+    }
+
+    if (x < width) {
+        uint32_t ys[6];
+        uint32_t us[3];
+        uint32_t vs[3];
+        for (uint32_t i = 0; i < 6; ++i) {
+            ys[i] = (x + i < width) ? luma(x + i) : 0;
+        }
+        for (uint32_t j = 0; j < 3; ++j) {
+            uint32_t chroma_x = x / 2 + j;
+            if (chroma_x * 2 < width) {
+                chroma(chroma_x, us[j], vs[j]);
+            } else {
+                us[j] = V210_CHROMA_NEUTRAL;
+                vs[j] = V210_CHROMA_NEUTRAL;
+            }
+        }
+        store_group(dst, ys[0], ys[1], ys[2], ys[3], ys[4], ys[5],
+                    us[0], us[1], us[2], vs[0], vs[1], vs[2]);
+    }
+}
+
+// 4:4:4 chroma is averaged over each pixel pair; the sum of two 8-bit
+// samples shifted left once is their 10-bit mean
+void pack_row_i444_from(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                        uint32_t start, uint32_t width, uint8_t *dst)
+{
+    pack_row_generic(start, width, dst,
+        [&](uint32_t x) -> uint32_t { return y_line[x] << 2; },
+        [&](uint32_t j, uint32_t &u, uint32_t &v) {
+            uint32_t x = 2 * j;
+            if (x + 1 < width) {
+                u = (u_line[x] + u_line[x + 1]) << 1;
+                v = (v_line[x] + v_line[x + 1]) << 1;
+            } else {
+                u = u_line[x] << 2;
+                v = v_line[x] << 2;
+            }
+        });
+}
+
+void pack_row_i444_scalar(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                          uint32_t width, uint8_t *dst)
+{
+    pack_row_i444_from(y_line, u_line, v_line, 0, width, dst);
+}
+
+// P010: 16-bit little-endian samples with the value in the top 10 bits,
+// interleaved UV; I010: 16-bit samples with the value in the low 10 bits
+void pack_row_p010_from(const uint8_t *y_line, const uint8_t *u_line, uint32_t start, uint32_t width, uint8_t *dst)
+{
+    const uint16_t *y16 = reinterpret_cast<const uint16_t*>(y_line);
+    const uint16_t *uv16 = reinterpret_cast<const uint16_t*>(u_line);
+    pack_row_generic(start, width, dst,
+        [&](uint32_t x) -> uint32_t { return y16[x] >> 6; },
+        [&](uint32_t j, uint32_t &u, uint32_t &v) {
+            u = uv16[2 * j] >> 6;
+            v = uv16[2 * j + 1] >> 6;
+        });
+}
+
+void pack_row_p010_scalar(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *,
+                          uint32_t width, uint8_t *dst)
+{
+    pack_row_p010_from(y_line, u_line, 0, width, dst);
+}
+
+void pack_row_i010_from(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                        uint32_t start, uint32_t width, uint8_t *dst)
+{
+    const uint16_t *y16 = reinterpret_cast<const uint16_t*>(y_line);
+    const uint16_t *u16 = reinterpret_cast<const uint16_t*>(u_line);
+    const uint16_t *v16 = reinterpret_cast<const uint16_t*>(v_line);
+    pack_row_generic(start, width, dst,
+        [&](uint32_t x) -> uint32_t { return y16[x] & 0x3FF; },
+        [&](uint32_t j, uint32_t &u, uint32_t &v) {
+            u = u16[j] & 0x3FF;
+            v = v16[j] & 0x3FF;
+        });
+}
+
+void pack_row_i010_scalar(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                          uint32_t width, uint8_t *dst)
+{
+    pack_row_i010_from(y_line, u_line, v_line, 0, width, dst);
+}
+
+// Full-range 8-bit RGB to limited-range 10-bit BT.709 YCbCr in 16.16 fixed
+// point (Y scaled by 876/255, Cb/Cr by 896/255). Each chroma row sums to 0,
+// so greys map to exactly neutral chroma.
+constexpr int32_t RGB_Y_R = 47864, RGB_Y_G = 161017, RGB_Y_B = 16255;
+constexpr int32_t RGB_CB_R = -26383, RGB_CB_G = -88755, RGB_CB_B = 115138;
+constexpr int32_t RGB_CR_R = 115138, RGB_CR_G = -104581, RGB_CR_B = -10557;
+
+inline uint32_t clamp_10bit(int32_t value)
+{
+    return static_cast<uint32_t>(value < 4 ? 4 : (value > 1019 ? 1019 : value));
+}
+
+// R, G and B byte offsets within a 4-byte pixel
+template <int R, int G, int B>
+void pack_row_rgb32_scalar(const uint8_t *line, uint32_t width, uint8_t *dst)
+{
+    pack_row_generic(0, width, dst,
+        [&](uint32_t x) -> uint32_t {
+            const uint8_t *px = line + 4 * x;
+            return static_cast<uint32_t>(((64 << 16) + RGB_Y_R * px[R] + RGB_Y_G * px[G] +
+                                          RGB_Y_B * px[B] + (1 << 15)) >> 16);
+        },
+        [&](uint32_t j, uint32_t &u, uint32_t &v) {
+            // Chroma of the pixel pair: sum both pixels and halve in the shift
+            const uint8_t *px = line + 8 * j;
+            bool pair = 2 * j + 1 < width;
+            int32_t r = pair ? px[R] + px[4 + R] : 2 * px[R];
+            int32_t g = pair ? px[G] + px[4 + G] : 2 * px[G];
+            int32_t b = pair ? px[B] + px[4 + B] : 2 * px[B];
+            u = clamp_10bit(((512 << 17) + RGB_CB_R * r + RGB_CB_G * g + RGB_CB_B * b + (1 << 16)) >> 17);
+            v = clamp_10bit(((512 << 17) + RGB_CR_R * r + RGB_CR_G * g + RGB_CR_B * b + (1 << 16)) >> 17);
+        });
+}
+
+void pack_row_rgba_scalar(const uint8_t *y_line, const uint8_t *, const uint8_t *, uint32_t width, uint8_t *dst)
+{
+    pack_row_rgb32_scalar<0, 1, 2>(y_line, width, dst);
+}
+
+void pack_row_bgra_scalar(const uint8_t *y_line, const uint8_t *, const uint8_t *, uint32_t width, uint8_t *dst)
+{
+    pack_row_rgb32_scalar<2, 1, 0>(y_line, width, dst);
+}
+
+// The vector packers gather one 6-pixel group into a 16-byte register: luma
+// Y0..Y7 in bytes 0-7 and the group's chroma in bytes 8-15 (NV12: U0 V0 U1 V1
+// U2 V2, I420: U0 U1 U2 - V0 V1 V2). Three byte shuffles then zero-extend the
+// samples for the low, middle and high 10-bit field of each output word, and
+// the word is (low << 2) | (mid << 12) | (high << 22). A group reads 8 luma
+// bytes, so the vector loops stop while x + 8 <= width and leave the rest of
+// the line to the scalar packer.
+#define Z 0x80
+const uint8_t NV12_FIELD_LO[16] = { 8, Z, Z, Z, 1, Z, Z, Z, 11, Z, Z, Z, 4, Z, Z, Z};
+const uint8_t NV12_FIELD_MID[16] = { 0, Z, Z, Z, 10, Z, Z, Z, 3, Z, Z, Z, 13, Z, Z, Z};
+const uint8_t NV12_FIELD_HI[16] = { 9, Z, Z, Z, 2, Z, Z, Z, 12, Z, Z, Z, 5, Z, Z, Z};
+const uint8_t I420_FIELD_LO[16] = { 8, Z, Z, Z, 1, Z, Z, Z, 13, Z, Z, Z, 4, Z, Z, Z};
+const uint8_t I420_FIELD_MID[16] = { 0, Z, Z, Z, 9, Z, Z, Z, 3, Z, Z, Z, 14, Z, Z, Z};
+const uint8_t I420_FIELD_HI[16] = { 12, Z, Z, Z, 2, Z, Z, Z, 10, Z, Z, Z, 5, Z, Z, Z};
+
+// Wider sources are first reduced to 10-bit samples in 16-bit lanes: luma
+// Y0..Y7 in one register, chroma in another (P010: U0 V0 U1 V1 U2 V2, I010
+// and I444 pair sums: U0..U3 - V0..V3). Every field takes its sample from
+// one of the two, so it is the OR of a shuffle of each, and the word is
+// low | (mid << 10) | (high << 20). Masks are indexed low, mid, high.
+const uint8_t WIDE_LUMA_FIELDS[3][16] = {
+    { Z, Z, Z, Z, 2, 3, Z, Z, Z, Z, Z, Z, 8, 9, Z, Z},
+    { 0, 1, Z, Z, Z, Z, Z, Z, 6, 7, Z, Z, Z, Z, Z, Z},
+    { Z, Z, Z, Z, 4, 5, Z, Z, Z, Z, Z, Z, 10, 11, Z, Z},
+};
+const uint8_t P010_CHROMA_FIELDS[3][16] = {
+    { 0, 1, Z, Z, Z, Z, Z, Z, 6, 7, Z, Z, Z, Z, Z, Z},
+    { Z, Z, Z, Z, 4, 5, Z, Z, Z, Z, Z, Z, 10, 11, Z, Z},
+    { 2, 3, Z, Z, Z, Z, Z, Z, 8, 9, Z, Z, Z, Z, Z, Z},
+};
+const uint8_t I010_CHROMA_FIELDS[3][16] = {
+    { 0, 1, Z, Z, Z, Z, Z, Z, 10, 11, Z, Z, Z, Z, Z, Z},
+    { Z, Z, Z, Z, 2, 3, Z, Z, Z, Z, Z, Z, 12, 13, Z, Z},
+    { 8, 9, Z, Z, Z, Z, Z, Z, 4, 5, Z, Z, Z, Z, Z, Z},
+};
+#undef Z
+
+#if MXL_V210_X86
+__attribute__((target("sse4.1")))
+inline __m128i pack_group_sse41(__m128i group, __m128i lo, __m128i mid, __m128i hi)
+{
+    __m128i words = _mm_slli_epi32(_mm_shuffle_epi8(group, lo), 2);
+    words = _mm_or_si128(words, _mm_slli_epi32(_mm_shuffle_epi8(group, mid), 12));
+    return _mm_or_si128(words, _mm_slli_epi32(_mm_shuffle_epi8(group, hi), 22));
+}
+
+__attribute__((target("sse4.1")))
+inline __m128i load_group_nv12_sse41(const uint8_t *y, const uint8_t *uv)
+{
+    return _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y)),
+                              _mm_loadl_epi64(reinterpret_cast<const __m128i*>(uv)));
+}
+
+__attribute__((target("sse4.1")))
+inline __m128i load_group_i420_sse41(const uint8_t *y, const uint8_t *u, const uint8_t *v)
+{
+    uint32_t u4;
+    uint32_t v4;
+    memcpy(&u4, u, sizeof(u4));
+    memcpy(&v4, v, sizeof(v4));
+    __m128i chroma = _mm_unpacklo_epi32(_mm_cvtsi32_si128(static_cast<int>(u4)), _mm_cvtsi32_si128(static_cast<int>(v4)));
+    return _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y)), chroma);
+}
+
+__attribute__((target("sse4.1")))
+void pack_row_nv12_sse41(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                         uint32_t width, uint8_t *dst)
+{
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(NV12_FIELD_LO));
+    const __m128i mid = _mm_loadu_si128(reinterpret_cast<const __m128i*>(NV12_FIELD_MID));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(NV12_FIELD_HI));
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 6) {
+        __m128i group = load_group_nv12_sse41(y_line + x, u_line + x);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (x / 6) * 16), pack_group_sse41(group, lo, mid, hi));
+    }
+    pack_row_8bit_scalar(y_line, u_line, v_line, 2, x, width, dst);
+}
+
+__attribute__((target("sse4.1")))
+void pack_row_i420_sse41(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                         uint32_t width, uint8_t *dst)
+{
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(I420_FIELD_LO));
+    const __m128i mid = _mm_loadu_si128(reinterpret_cast<const __m128i*>(I420_FIELD_MID));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(I420_FIELD_HI));
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 6) {
+        __m128i group = load_group_i420_sse41(y_line + x, u_line + x / 2, v_line + x / 2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (x / 6) * 16), pack_group_sse41(group, lo, mid, hi));
+    }
+    pack_row_8bit_scalar(y_line, u_line, v_line, 1, x, width, dst);
+}
+
+// Field masks for the wide packers: luma low/mid/high, then chroma low/mid/high
+__attribute__((target("sse4.1")))
+inline void load_wide_masks_sse41(const uint8_t (*chroma_fields)[16], __m128i *masks)
+{
+    for (int i = 0; i < 3; i++) {
+        masks[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(WIDE_LUMA_FIELDS[i]));
+        masks[3 + i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chroma_fields[i]));
+    }
+}
+
+__attribute__((target("sse4.1")))
+inline __m128i pack_group_wide_sse41(__m128i luma, __m128i chroma, const __m128i *masks)
+{
+    __m128i lo = _mm_or_si128(_mm_shuffle_epi8(luma, masks[0]), _mm_shuffle_epi8(chroma, masks[3]));
+    __m128i mid = _mm_or_si128(_mm_shuffle_epi8(luma, masks[1]), _mm_shuffle_epi8(chroma, masks[4]));
+    __m128i hi = _mm_or_si128(_mm_shuffle_epi8(luma, masks[2]), _mm_shuffle_epi8(chroma, masks[5]));
+    return _mm_or_si128(_mm_or_si128(lo, _mm_slli_epi32(mid, 10)), _mm_slli_epi32(hi, 20));
+}
+
+// Group loaders for the wide packers, 10-bit values in 16-bit lanes
+__attribute__((target("sse4.1")))
+inline void load_group_p010_sse41(const uint8_t *y, const uint8_t *uv, __m128i &luma, __m128i &chroma)
+{
+    luma = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y)), 6);
+    chroma = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(uv)), 6);
+}
+
+__attribute__((target("sse4.1")))
+inline void load_group_i010_sse41(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                  __m128i &luma, __m128i &chroma)
+{
+    const __m128i ten_bits = _mm_set1_epi16(0x3FF);
+    luma = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y)), ten_bits);
+    chroma = _mm_and_si128(_mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u)),
+                                              _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v))), ten_bits);
+}
+
+// I444 chroma pairs are summed to 16 bits and shifted left once, the 10-bit mean
+__attribute__((target("sse4.1")))
+inline void load_group_i444_sse41(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                  __m128i &luma, __m128i &chroma)
+{
+    const __m128i ones = _mm_set1_epi8(1);
+    luma = _mm_slli_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y))), 2);
+    __m128i u_sums = _mm_maddubs_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u)), ones);
+    __m128i v_sums = _mm_maddubs_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v)), ones);
+    chroma = _mm_slli_epi16(_mm_unpacklo_epi64(u_sums, v_sums), 1);
+}
+
+// Samples are 16-bit, so a group still reads 8 luma samples (and for P010
+// 8 chroma samples); the loops stop at the same x + 8 <= width as above
+__attribute__((target("sse4.1")))
+void pack_row_p010_sse41(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *,
+                         uint32_t width, uint8_t *dst)
+{
+    __m128i masks[6];
+    load_wide_masks_sse41(P010_CHROMA_FIELDS, masks);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 6) {
+        __m128i luma;
+        __m128i chroma;
+        load_group_p010_sse41(y_line + 2 * x, u_line + 2 * x, luma, chroma);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (x / 6) * 16), pack_group_wide_sse41(luma, chroma, masks));
+    }
+    pack_row_p010_from(y_line, u_line, x, width, dst);
+}
+
+__attribute__((target("sse4.1")))
+void pack_row_i010_sse41(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                         uint32_t width, uint8_t *dst)
+{
+    __m128i masks[6];
+    load_wide_masks_sse41(I010_CHROMA_FIELDS, masks);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 6) {
+        __m128i luma;
+        __m128i chroma;
+        load_group_i010_sse41(y_line + 2 * x, u_line + x, v_line + x, luma, chroma);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (x / 6) * 16), pack_group_wide_sse41(luma, chroma, masks));
+    }
+    pack_row_i010_from(y_line, u_line, v_line, x, width, dst);
+}
+
+__attribute__((target("sse4.1")))
+void pack_row_i444_sse41(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                         uint32_t width, uint8_t *dst)
+{
+    __m128i masks[6];
+    load_wide_masks_sse41(I010_CHROMA_FIELDS, masks);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 6) {
+        __m128i luma;
+        __m128i chroma;
+        load_group_i444_sse41(y_line + x, u_line + x, v_line + x, luma, chroma);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (x / 6) * 16), pack_group_wide_sse41(luma, chroma, masks));
+    }
+    pack_row_i444_from(y_line, u_line, v_line, x, width, dst);
+}
+
+// AVX2 packs two groups per iteration, one per 128-bit lane (byte shuffles
+// stay within a lane)
+__attribute__((target("avx2")))
+inline __m256i pack_groups_avx2(__m256i groups, __m256i lo, __m256i mid, __m256i hi)
+{
+    __m256i words = _mm256_slli_epi32(_mm256_shuffle_epi8(groups, lo), 2);
+    words = _mm256_or_si256(words, _mm256_slli_epi32(_mm256_shuffle_epi8(groups, mid), 12));
+    return _mm256_or_si256(words, _mm256_slli_epi32(_mm256_shuffle_epi8(groups, hi), 22));
+}
+
+__attribute__((target("avx2")))
+inline __m256i broadcast_mask_avx2(const uint8_t *mask)
+{
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mask)));
+}
+
+__attribute__((target("avx2")))
+void pack_row_nv12_avx2(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                        uint32_t width, uint8_t *dst)
+{
+    const __m256i lo = broadcast_mask_avx2(NV12_FIELD_LO);
+    const __m256i mid = broadcast_mask_avx2(NV12_FIELD_MID);
+    const __m256i hi = broadcast_mask_avx2(NV12_FIELD_HI);
+    uint32_t x = 0;
+    for (; x + 14 <= width; x += 12) {
+        __m128i first = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y_line + x)),
+                                           _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u_line + x)));
+        __m128i second = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y_line + x + 6)),
+                                            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u_line + x + 6)));
+        __m256i groups = _mm256_inserti128_si256(_mm256_castsi128_si256(first), second, 1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (x / 6) * 16), pack_groups_avx2(groups, lo, mid, hi));
+    }
+    // The compiler does not clear the upper halves before the tail call;
+    // leaving them dirty slows down any legacy SSE code that runs next
+    _mm256_zeroupper();
+    pack_row_8bit_scalar(y_line, u_line, v_line, 2, x, width, dst);
+}
+
+__attribute__((target("avx2")))
+void pack_row_i420_avx2(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                        uint32_t width, uint8_t *dst)
+{
+    const __m256i lo = broadcast_mask_avx2(I420_FIELD_LO);
+    const __m256i mid = broadcast_mask_avx2(I420_FIELD_MID);
+    const __m256i hi = broadcast_mask_avx2(I420_FIELD_HI);
+    uint32_t x = 0;
+    // The 8-byte chroma loads cover both groups, so they need two spare samples
+    for (; x + 16 <= width; x += 12) {
+        __m128i y_first = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(y_line + x));
+        __m128i y_second = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(y_line + x + 6));
+        __m128i u = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u_line + x / 2));
+        __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v_line + x / 2));
+        __m128i chroma_first = _mm_unpacklo_epi32(u, v);
+        __m128i chroma_second = _mm_unpacklo_epi32(_mm_srli_si128(u, 3), _mm_srli_si128(v, 3));
+        __m256i groups = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_unpacklo_epi64(y_first, chroma_first)),
+            _mm_unpacklo_epi64(y_second, chroma_second), 1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (x / 6) * 16), pack_groups_avx2(groups, lo, mid, hi));
+    }
+    _mm256_zeroupper();
+    pack_row_8bit_scalar(y_line, u_line, v_line, 1, x, width, dst);
+}
+
+__attribute__((target("avx2")))
+inline __m256i pack_groups_wide_avx2(__m256i luma, __m256i chroma, const __m256i *masks)
+{
+    __m256i lo = _mm256_or_si256(_mm256_shuffle_epi8(luma, masks[0]), _mm256_shuffle_epi8(chroma, masks[3]));
+    __m256i mid = _mm256_or_si256(_mm256_shuffle_epi8(luma, masks[1]), _mm256_shuffle_epi8(chroma, masks[4]));
+    __m256i hi = _mm256_or_si256(_mm256_shuffle_epi8(luma, masks[2]), _mm256_shuffle_epi8(chroma, masks[5]));
+    return _mm256_or_si256(_mm256_or_si256(lo, _mm256_slli_epi32(mid, 10)), _mm256_slli_epi32(hi, 20));
+}
+
+__attribute__((target("avx2")))
+inline void load_wide_masks_avx2(const uint8_t (*chroma_fields)[16], __m256i *masks)
+{
+    for (int i = 0; i < 3; i++) {
+        masks[i] = broadcast_mask_avx2(WIDE_LUMA_FIELDS[i]);
+        masks[3 + i] = broadcast_mask_avx2(chroma_fields[i]);
+    }
+}
+
+__attribute__((target("avx2")))
+inline __m256i combine_lanes_avx2(__m128i first, __m128i second)
+{
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(first), second, 1);
+}
+
+// The wide AVX2 packers build each lane with the SSE4.1 group loaders; the
+// second group's loads end 14 pixels in, hence x + 14 <= width
+__attribute__((target("avx2")))
+void pack_row_p010_avx2(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *,
+                        uint32_t width, uint8_t *dst)
+{
+    __m256i masks[6];
+    load_wide_masks_avx2(P010_CHROMA_FIELDS, masks);
+    uint32_t x = 0;
+    for (; x + 14 <= width; x += 12) {
+        __m128i luma[2];
+        __m128i chroma[2];
+        load_group_p010_sse41(y_line + 2 * x, u_line + 2 * x, luma[0], chroma[0]);
+        load_group_p010_sse41(y_line + 2 * (x + 6), u_line + 2 * (x + 6), luma[1], chroma[1]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (x / 6) * 16),
+                            pack_groups_wide_avx2(combine_lanes_avx2(luma[0], luma[1]),
+                                                  combine_lanes_avx2(chroma[0], chroma[1]), masks));
+    }
+    _mm256_zeroupper();
+    pack_row_p010_from(y_line, u_line, x, width, dst);
+}
+
+__attribute__((target("avx2")))
+void pack_row_i010_avx2(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                        uint32_t width, uint8_t *dst)
+{
+    __m256i masks[6];
+    load_wide_masks_avx2(I010_CHROMA_FIELDS, masks);
+    uint32_t x = 0;
+    for (; x + 14 <= width; x += 12) {
+        __m128i luma[2];
+        __m128i chroma[2];
+        load_group_i010_sse41(y_line + 2 * x, u_line + x, v_line + x, luma[0], chroma[0]);
+        load_group_i010_sse41(y_line + 2 * (x + 6), u_line + x + 6, v_line + x + 6, luma[1], chroma[1]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (x / 6) * 16),
+                            pack_groups_wide_avx2(combine_lanes_avx2(luma[0], luma[1]),
+                                                  combine_lanes_avx2(chroma[0], chroma[1]), masks));
+    }
+    _mm256_zeroupper();
+    pack_row_i010_from(y_line, u_line, v_line, x, width, dst);
+}
+
+__attribute__((target("avx2")))
+void pack_row_i444_avx2(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                        uint32_t width, uint8_t *dst)
+{
+    __m256i masks[6];
+    load_wide_masks_avx2(I010_CHROMA_FIELDS, masks);
+    uint32_t x = 0;
+    for (; x + 14 <= width; x += 12) {
+        __m128i luma[2];
+        __m128i chroma[2];
+        load_group_i444_sse41(y_line + x, u_line + x, v_line + x, luma[0], chroma[0]);
+        load_group_i444_sse41(y_line + x + 6, u_line + x + 6, v_line + x + 6, luma[1], chroma[1]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (x / 6) * 16),
+                            pack_groups_wide_avx2(combine_lanes_avx2(luma[0], luma[1]),
+                                                  combine_lanes_avx2(chroma[0], chroma[1]), masks));
+    }
+    _mm256_zeroupper();
+    pack_row_i444_from(y_line, u_line, v_line, x, width, dst);
+}
+#endif
+
+#if MXL_V210_NEON
+inline uint8x16_t pack_group_neon(uint8x16_t group, uint8x16_t lo, uint8x16_t mid, uint8x16_t hi)
+{
+    uint32x4_t words = vshlq_n_u32(vreinterpretq_u32_u8(vqtbl1q_u8(group, lo)), 2);
+    words = vorrq_u32(words, vshlq_n_u32(vreinterpretq_u32_u8(vqtbl1q_u8(group, mid)), 12));
+    words = vorrq_u32(words, vshlq_n_u32(vreinterpretq_u32_u8(vqtbl1q_u8(group, hi)), 22));
+    return vreinterpretq_u8_u32(words);
+}
+
+void pack_row_nv12_neon(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                        uint32_t width, uint8_t *dst)
+{
+    const uint8x16_t lo = vld1q_u8(NV12_FIELD_LO);
+    const uint8x16_t mid = vld1q_u8(NV12_FIELD_MID);
+    const uint8x16_t hi = vld1q_u8(NV12_FIELD_HI);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 6) {
+        uint8x16_t group = vcombine_u8(vld1_u8(y_line + x), vld1_u8(u_line + x));
+        vst1q_u8(dst + (x / 6) * 16, pack_group_neon(group, lo, mid, hi));
+    }
+    pack_row_8bit_scalar(y_line, u_line, v_line, 2, x, width, dst);
+}
+
+void pack_row_i420_neon(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                        uint32_t width, uint8_t *dst)
+{
+    const uint8x16_t lo = vld1q_u8(I420_FIELD_LO);
+    const uint8x16_t mid = vld1q_u8(I420_FIELD_MID);
+    const uint8x16_t hi = vld1q_u8(I420_FIELD_HI);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 6) {
+        uint32_t u4;
+        uint32_t v4;
+        memcpy(&u4, u_line + x / 2, sizeof(u4));
+        memcpy(&v4, v_line + x / 2, sizeof(v4));
+        uint8x8_t chroma = vreinterpret_u8_u32(vset_lane_u32(v4, vdup_n_u32(u4), 1));
+        uint8x16_t group = vcombine_u8(vld1_u8(y_line + x), chroma);
+        vst1q_u8(dst + (x / 6) * 16, pack_group_neon(group, lo, mid, hi));
+    }
+    pack_row_8bit_scalar(y_line, u_line, v_line, 1, x, width, dst);
+}
+
+inline uint8x16_t pack_group_wide_neon(uint16x8_t luma, uint16x8_t chroma, const uint8x16_t *masks)
+{
+    uint8x16_t luma8 = vreinterpretq_u8_u16(luma);
+    uint8x16_t chroma8 = vreinterpretq_u8_u16(chroma);
+    uint32x4_t lo = vreinterpretq_u32_u8(vorrq_u8(vqtbl1q_u8(luma8, masks[0]), vqtbl1q_u8(chroma8, masks[3])));
+    uint32x4_t mid = vreinterpretq_u32_u8(vorrq_u8(vqtbl1q_u8(luma8, masks[1]), vqtbl1q_u8(chroma8, masks[4])));
+    uint32x4_t hi = vreinterpretq_u32_u8(vorrq_u8(vqtbl1q_u8(luma8, masks[2]), vqtbl1q_u8(chroma8, masks[5])));
+    return vreinterpretq_u8_u32(vorrq_u32(vorrq_u32(lo, vshlq_n_u32(mid, 10)), vshlq_n_u32(hi, 20)));
+}
+
+inline void load_wide_masks_neon(const uint8_t (*chroma_fields)[16], uint8x16_t *masks)
+{
+    for (int i = 0; i < 3; i++) {
+        masks[i] = vld1q_u8(WIDE_LUMA_FIELDS[i]);
+        masks[3 + i] = vld1q_u8(chroma_fields[i]);
+    }
+}
+
+void pack_row_p010_neon(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *,
+                        uint32_t width, uint8_t *dst)
+{
+    uint8x16_t masks[6];
+    load_wide_masks_neon(P010_CHROMA_FIELDS, masks);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 6) {
+        uint16x8_t luma = vshrq_n_u16(vreinterpretq_u16_u8(vld1q_u8(y_line + 2 * x)), 6);
+        uint16x8_t chroma = vshrq_n_u16(vreinterpretq_u16_u8(vld1q_u8(u_line + 2 * x)), 6);
+        vst1q_u8(dst + (x / 6) * 16, pack_group_wide_neon(luma, chroma, masks));
+    }
+    pack_row_p010_from(y_line, u_line, x, width, dst);
+}
+
+void pack_row_i010_neon(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                        uint32_t width, uint8_t *dst)
+{
+    uint8x16_t masks[6];
+    load_wide_masks_neon(I010_CHROMA_FIELDS, masks);
+    const uint16x8_t ten_bits = vdupq_n_u16(0x3FF);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 6) {
+        uint16x8_t luma = vandq_u16(vreinterpretq_u16_u8(vld1q_u8(y_line + 2 * x)), ten_bits);
+        uint16x8_t chroma = vandq_u16(vreinterpretq_u16_u8(vcombine_u8(vld1_u8(u_line + x), vld1_u8(v_line + x))),
+                                      ten_bits);
+        vst1q_u8(dst + (x / 6) * 16, pack_group_wide_neon(luma, chroma, masks));
+    }
+    pack_row_i010_from(y_line, u_line, v_line, x, width, dst);
+}
+
+void pack_row_i444_neon(const uint8_t *y_line, const uint8_t *u_line, const uint8_t *v_line,
+                        uint32_t width, uint8_t *dst)
+{
+    uint8x16_t masks[6];
+    load_wide_masks_neon(I010_CHROMA_FIELDS, masks);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 6) {
+        uint16x8_t luma = vshlq_n_u16(vmovl_u8(vld1_u8(y_line + x)), 2);
+        uint16x8_t chroma = vshlq_n_u16(vcombine_u16(vpaddl_u8(vld1_u8(u_line + x)), vpaddl_u8(vld1_u8(v_line + x))), 1);
+        vst1q_u8(dst + (x / 6) * 16, pack_group_wide_neon(luma, chroma, masks));
+    }
+    pack_row_i444_from(y_line, u_line, v_line, x, width, dst);
+}
+#endif
+
+pack_row_fn select_row_packer(v210_source_format format, v210_isa isa)
+{
+    // Row layouts with vector packers. I422 lines have the same layout as
+    // I420 lines and P216/I210 lines match P010/I010 lines, only with one
+    // chroma line per row.
+    enum { LAYOUT_NV12, LAYOUT_I420, LAYOUT_I444, LAYOUT_P010, LAYOUT_I010 } layout;
+    switch (format) {
+    case V210_SOURCE_NV12: layout = LAYOUT_NV12; break;
+    case V210_SOURCE_I420:
+    case V210_SOURCE_I422: layout = LAYOUT_I420; break;
+    case V210_SOURCE_I444: layout = LAYOUT_I444; break;
+    case V210_SOURCE_P010:
+    case V210_SOURCE_P216: layout = LAYOUT_P010; break;
+    case V210_SOURCE_I010:
+    case V210_SOURCE_I210: layout = LAYOUT_I010; break;
+    // Scalar only, see mxl-v210.h
+    case V210_SOURCE_RGBA: return pack_row_rgba_scalar;
+    case V210_SOURCE_BGRA: return pack_row_bgra_scalar;
+    default: return nullptr;
+    }
+
+    switch (isa) {
+    case V210_ISA_SCALAR: {
+        static const pack_row_fn scalar[] = {pack_row_nv12_scalar, pack_row_i420_scalar, pack_row_i444_scalar,
+                                             pack_row_p010_scalar, pack_row_i010_scalar};
+        return scalar[layout];
+    }
+#if MXL_V210_X86
+    case V210_ISA_SSE41: {
+        static const pack_row_fn sse41[] = {pack_row_nv12_sse41, pack_row_i420_sse41, pack_row_i444_sse41,
+                                            pack_row_p010_sse41, pack_row_i010_sse41};
+        return sse41[layout];
+    }
+    case V210_ISA_AVX2: {
+        static const pack_row_fn avx2[] = {pack_row_nv12_avx2, pack_row_i420_avx2, pack_row_i444_avx2,
+                                           pack_row_p010_avx2, pack_row_i010_avx2};
+        return avx2[layout];
+    }
+#endif
+#if MXL_V210_NEON
+    case V210_ISA_NEON: {
+        static const pack_row_fn neon[] = {pack_row_nv12_neon, pack_row_i420_neon, pack_row_i444_neon,
+                                           pack_row_p010_neon, pack_row_i010_neon};
+        return neon[layout];
+    }
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+// 4:2:0 formats share one chroma line between two rows
+bool source_chroma_halved(v210_source_format format)
+{
+    return format == V210_SOURCE_NV12 || format == V210_SOURCE_I420 ||
+           format == V210_SOURCE_P010 || format == V210_SOURCE_I010;
+}
+} // namespace
+
+uint32_t v210_source_plane_count(v210_source_format format)
+{
+    switch (format) {
+    case V210_SOURCE_RGBA:
+    case V210_SOURCE_BGRA:
+        return 1;
+    case V210_SOURCE_NV12:
+    case V210_SOURCE_P010:
+    case V210_SOURCE_P216:
+        return 2;
+    default:
+        return 3;
+    }
+}
+
+size_t v210_line_bytes(uint32_t width)
+{
+    return static_cast<size_t>((width + 5) / 6) * 16;
+}
+
+const char *v210_source_format_name(v210_source_format format)
+{
+    switch (format) {
+    case V210_SOURCE_NV12: return "NV12";
+    case V210_SOURCE_I420: return "I420";
+    case V210_SOURCE_I422: return "I422";
+    case V210_SOURCE_I444: return "I444";
+    case V210_SOURCE_P010: return "P010";
+    case V210_SOURCE_I010: return "I010";
+    case V210_SOURCE_RGBA: return "RGBA";
+    case V210_SOURCE_BGRA: return "BGRA";
+    case V210_SOURCE_P216: return "P216";
+    case V210_SOURCE_I210: return "I210";
+    }
+    return "unknown";
+}
+
+const char *v210_isa_name(v210_isa isa)
+{
+    switch (isa) {
+    case V210_ISA_SCALAR: return "scalar";
+    case V210_ISA_SSE41: return "sse4.1";
+    case V210_ISA_AVX2: return "avx2";
+    case V210_ISA_NEON: return "neon";
+    default: return "unknown";
+    }
+}
+
+bool v210_isa_supported(v210_isa isa)
+{
+    switch (isa) {
+    case V210_ISA_SCALAR:
+        return true;
+#if MXL_V210_X86
+    case V210_ISA_SSE41:
+        return __builtin_cpu_supports("sse4.1");
+    case V210_ISA_AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+#if MXL_V210_NEON
+    case V210_ISA_NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+v210_isa v210_best_isa()
+{
+    // Resolved once; CPU features do not change while the process runs
+    static const v210_isa best = [] {
+        const v210_isa preferred[] = {V210_ISA_AVX2, V210_ISA_SSE41, V210_ISA_NEON};
+        for (v210_isa isa : preferred) {
+            if (v210_isa_supported(isa)) {
+                return isa;
+            }
+        }
+        return V210_ISA_SCALAR;
+    }();
+    return best;
+}
+
+bool v210_pack_rows(const v210_source &src, uint8_t *dst, size_t dst_stride, v210_isa isa,
+                    uint32_t row_begin, uint32_t row_end)
+{
+    if (!dst || src.width == 0 || src.height == 0) {
+        return false;
+    }
+    uint32_t plane_count = v210_source_plane_count(src.format);
+    for (uint32_t i = 0; i < plane_count; i++) {
+        if (!src.planes[i]) {
+            return false;
+        }
+    }
+    if (!v210_isa_supported(isa)) {
+        return false;
+    }
+    pack_row_fn pack_row = select_row_packer(src.format, isa);
+    if (!pack_row) {
+        return false;
+    }
+
+    bool halved = source_chroma_halved(src.format);
+    row_end = row_end < src.height ? row_end : src.height;
+    for (uint32_t y = row_begin; y < row_end; y++) {
+        const uint8_t *y_line = src.planes[0] + static_cast<size_t>(y) * src.linesize[0];
+        const uint8_t *u_line = y_line;
+        const uint8_t *v_line = y_line;
+        uint32_t chroma_y = halved ? y / 2 : y;
+        if (plane_count >= 2) {
+            u_line = src.planes[1] + static_cast<size_t>(chroma_y) * src.linesize[1];
+            v_line = plane_count == 2 ? u_line + 1 : src.planes[2] + static_cast<size_t>(chroma_y) * src.linesize[2];
+        }
+        pack_row(y_line, u_line, v_line, src.width, dst + y * dst_stride);
+    }
+    return true;
+}
+
+bool v210_pack(const v210_source &src, uint8_t *dst, size_t dst_stride, v210_isa isa)
+{
+    return v210_pack_rows(src, dst, dst_stride, isa, 0, src.height);
+}
+
+void v210_clear_padding(uint8_t *dst, size_t dst_stride, uint32_t width, uint32_t height,
+                        size_t dst_size)
+{
+    size_t line_bytes = v210_line_bytes(width);
+    if (!dst || dst_stride < line_bytes) {
+        return;
+    }
+    if (dst_stride > line_bytes) {
+        for (uint32_t y = 0; y < height; y++) {
+            memset(dst + y * dst_stride + line_bytes, 0, dst_stride - line_bytes);
+        }
+    }
+    size_t used = dst_stride * height;
+    if (dst_size > used) {
+        memset(dst + used, 0, dst_size - used);
+    }
+}
+
+void v210_unpack_to_rgba(const uint8_t *src, size_t src_stride,
+                         uint32_t width, uint32_t height,
+                         uint8_t *dst, size_t dst_stride)
+{
+    for (uint32_t line = 0; line < height; line++) {
+        const uint8_t *line_start = src + line * src_stride;
+        uint32_t *rgba_line = reinterpret_cast<uint32_t*>(dst + line * dst_stride);
+
+        for (uint32_t x = 0; x < width; x += 6) {
+            const uint8_t *group = line_start + (x / 6) * 16;
+            uint32_t w0 = load_le32(group + 0);
+            uint32_t w1 = load_le32(group + 4);
+            uint32_t w2 = load_le32(group + 8);
+            uint32_t w3 = load_le32(group + 12);
+
+            // Extract YUV values from v210 packing and convert 10-bit to 8-bit
+            uint8_t y_vals[6] = {
+                (uint8_t)(((w0 >> 10) & 0x3FF) >> 2), (uint8_t)(((w1 >> 0) & 0x3FF) >> 2),
+                (uint8_t)(((w1 >> 20) & 0x3FF) >> 2), (uint8_t)(((w2 >> 10) & 0x3FF) >> 2),
+                (uint8_t)(((w3 >> 0) & 0x3FF) >> 2), (uint8_t)(((w3 >> 20) & 0x3FF) >> 2)
+            };
+            uint8_t u_vals[3] = {
+                (uint8_t)(((w0 >> 0) & 0x3FF) >> 2), (uint8_t)(((w1 >> 10) & 0x3FF) >> 2),
+                (uint8_t)(((w2 >> 20) & 0x3FF) >> 2)
+            };
+            uint8_t v_vals[3] = {
+                (uint8_t)(((w0 >> 20) & 0x3FF) >> 2), (uint8_t)(((w2 >> 0) & 0x3FF) >> 2),
+                (uint8_t)(((w3 >> 10) & 0x3FF) >> 2)
+            };
+
+            for (uint32_t i = 0; i < 6 && (x + i) < width; i++) {
+                // U and V are deliberately swapped and the pixel is stored as
+                // A<<24 | R<<16 | G<<8 | B; together these give correct colours
+                // for the RGBA frame OBS is told to expect.
+                uint8_t y = y_vals[i];
+                uint8_t u = v_vals[i / 2];
+                uint8_t v = u_vals[i / 2];
+
+                // YUV to RGB conversion using BT.709 coefficients
+                float yf = (float)y;
+                float uf = (float)u - 128.0f;
+                float vf = (float)v - 128.0f;
+
+                int r = (int)(yf + 1.5748f * vf);
+                int g = (int)(yf - 0.1873f * uf - 0.4681f * vf);
+                int b = (int)(yf + 1.8556f * uf);
+
+                r = (r < 0) ? 0 : (r > 255) ? 255 : r;
+                g = (g < 0) ? 0 : (g > 255) ? 255 : g;
+                b = (b < 0) ? 0 : (b > 255) ? 255 : b;
+
+                rgba_line[x + i] = (255u << 24) | (r << 16) | (g << 8) | b;
+            }
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Pixel conversion kernels between OBS frame layouts and v210 (10-bit 4:2:2,
+// six pixels packed into four little-endian 32-bit words:
+// Cb0 Y0 Cr0 | Y1 Cb1 Y2 | Cr1 Y3 Cb2 | Y4 Cr2 Y5).
+//
+// The kernels have no libobs dependency: the plugins map their
+// `enum video_format` onto `v210_source_format`, and the same code builds
+// into the standalone benchmarks under bench/.
+
+enum v210_source_format {
+    V210_SOURCE_NV12,
+    V210_SOURCE_I420,
+    V210_SOURCE_I422,
+    V210_SOURCE_I444, // chroma averaged over each pixel pair
+    V210_SOURCE_P010, // 10-bit samples kept at full precision
+    V210_SOURCE_I010,
+    V210_SOURCE_RGBA, // BT.709 limited range, fixed-point matrix
+    V210_SOURCE_BGRA,
+    V210_SOURCE_P216, // 4:2:2 with 16-bit samples, top 10 bits kept
+    V210_SOURCE_I210,
+};
+
+// Instruction set variants of the packers. All variants produce
+// bit-identical output; v210_best_isa() picks one at runtime. RGBA and BGRA
+// have no vector packers yet and use the scalar one for every variant; the
+// YUV formats all have SSE4.1, AVX2 and NEON packers.
+enum v210_isa {
+    V210_ISA_SCALAR,
+    V210_ISA_SSE41,
+    V210_ISA_AVX2,
+    V210_ISA_NEON,
+    V210_ISA_COUNT
+};
+
+struct v210_source {
+    v210_source_format format;
+    const uint8_t *planes[4];
+    uint32_t linesize[4];
+    uint32_t width;
+    uint32_t height;
+};
+
+// Bytes of packed pixel data in one v210 line (16 bytes per started 6-pixel group)
+size_t v210_line_bytes(uint32_t width);
+
+const char *v210_source_format_name(v210_source_format format);
+// Planes v210_source::planes must provide (1 for RGBA/BGRA, 2 for NV12/P010/P216, else 3)
+uint32_t v210_source_plane_count(v210_source_format format);
+const char *v210_isa_name(v210_isa isa);
+bool v210_isa_supported(v210_isa isa);
+
+// Fastest variant supported by the running CPU
+v210_isa v210_best_isa();
+
+// Pack `src` into v210 lines of `dst_stride` bytes using the given variant.
+// Pixels past the right edge of the last group are written as black with
+// neutral chroma. Returns false if the format or variant is not available.
+bool v210_pack(const v210_source &src, uint8_t *dst, size_t dst_stride, v210_isa isa);
+
+// Same as v210_pack for rows [row_begin, row_end) only, so bands of one
+// frame can be packed on different threads. `dst` still points at row 0.
+bool v210_pack_rows(const v210_source &src, uint8_t *dst, size_t dst_stride, v210_isa isa,
+                    uint32_t row_begin, uint32_t row_end);
+
+// Zero the bytes of a `dst_size` buffer that v210_pack leaves alone: line
+// padding between v210_line_bytes(width) and `dst_stride`, and anything after
+// the last line. Cheaper than clearing the whole buffer before packing.
+void v210_clear_padding(uint8_t *dst, size_t dst_stride, uint32_t width, uint32_t height,
+                        size_t dst_size);
+
+// Unpack v210 lines of `src_stride` bytes to 32-bit pixels for an OBS
+// VIDEO_FORMAT_RGBA frame (BT.709, 8-bit).
+void v210_unpack_to_rgba(const uint8_t *src, size_t src_stride,
+                         uint32_t width, uint32_t height,
+                         uint8_t *dst, size_t dst_stride);
@@ -0,0 +1,152 @@
+#include "mxl-source-stats.h"
+#include <sstream>
+#include <iomanip>
+
+mxl_histogram::mxl_histogram()
+{
+    reset();
+}
+
+void mxl_histogram::reset()
+{
+    for (auto &bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+void mxl_histogram::record(uint64_t value)
+{
+    int bucket = value ? 64 - __builtin_clzll(value) : 0;
+    if (bucket >= BUCKET_COUNT) {
+        bucket = BUCKET_COUNT - 1;
+    }
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t mxl_histogram::percentile(double p) const
+{
+    uint64_t total = count.load(std::memory_order_relaxed);
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(p * static_cast<double>(total));
+    if (target >= total) {
+        target = total - 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen > target) {
+            return i == 0 ? 0 : (1ULL << i) - 1;
+        }
+    }
+    return max.load(std::memory_order_relaxed);
+}
+
+uint64_t mxl_histogram::mean() const
+{
+    uint64_t total = count.load(std::memory_order_relaxed);
+    return total ? sum.load(std::memory_order_relaxed) / total : 0;
+}
+
+mxl_source_stats::mxl_source_stats()
+{
+    reset();
+}
+
+void mxl_source_stats::reset()
+{
+    grains_read.store(0, std::memory_order_relaxed);
+    too_early.store(0, std::memory_order_relaxed);
+    too_late.store(0, std::memory_order_relaxed);
+    invalid.store(0, std::memory_order_relaxed);
+    resyncs.store(0, std::memory_order_relaxed);
+    timeouts.store(0, std::memory_order_relaxed);
+    reopens.store(0, std::memory_order_relaxed);
+    errors.store(0, std::memory_order_relaxed);
+    conversion_ns.reset();
+    read_to_output_ns.reset();
+    head_lag.reset();
+}
+
+namespace {
+void histogram_to_json(std::ostream &ss, const char *name, const mxl_histogram &hist)
+{
+    ss << "\"" << name << "\":{";
+    ss << "\"count\":" << hist.count.load(std::memory_order_relaxed) << ",";
+    ss << "\"mean\":" << hist.mean() << ",";
+    ss << "\"p50\":" << hist.percentile(0.50) << ",";
+    ss << "\"p90\":" << hist.percentile(0.90) << ",";
+    ss << "\"p99\":" << hist.percentile(0.99) << ",";
+    ss << "\"max\":" << hist.max.load(std::memory_order_relaxed) << ",";
+    ss << "\"buckets\":[";
+    // Trailing empty buckets are omitted to keep the payload short
+    int last = mxl_histogram::BUCKET_COUNT - 1;
+    while (last > 0 && hist.buckets[last].load(std::memory_order_relaxed) == 0) {
+        last--;
+    }
+    for (int i = 0; i <= last; ++i) {
+        if (i > 0) {
+            ss << ",";
+        }
+        ss << hist.buckets[i].load(std::memory_order_relaxed);
+    }
+    ss << "]}";
+}
+
+double ns_to_ms(uint64_t ns)
+{
+    return static_cast<double>(ns) / 1000000.0;
+}
+} // namespace
+
+std::string mxl_source_stats::to_json() const
+{
+    std::stringstream ss;
+    ss << "{";
+    ss << "\"grains_read\":" << grains_read.load(std::memory_order_relaxed) << ",";
+    ss << "\"too_early\":" << too_early.load(std::memory_order_relaxed) << ",";
+    ss << "\"too_late\":" << too_late.load(std::memory_order_relaxed) << ",";
+    ss << "\"invalid\":" << invalid.load(std::memory_order_relaxed) << ",";
+    ss << "\"resyncs\":" << resyncs.load(std::memory_order_relaxed) << ",";
+    ss << "\"timeouts\":" << timeouts.load(std::memory_order_relaxed) << ",";
+    ss << "\"reopens\":" << reopens.load(std::memory_order_relaxed) << ",";
+    ss << "\"errors\":" << errors.load(std::memory_order_relaxed) << ",";
+    histogram_to_json(ss, "conversion_ns", conversion_ns);
+    ss << ",";
+    histogram_to_json(ss, "read_to_output_ns", read_to_output_ns);
+    ss << ",";
+    histogram_to_json(ss, "head_lag", head_lag);
+    ss << "}";
+    return ss.str();
+}
+
+std::string mxl_source_stats::to_text() const
+{
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << "Grains read: " << grains_read.load(std::memory_order_relaxed)
+       << " | too early: " << too_early.load(std::memory_order_relaxed)
+       << " | too late: " << too_late.load(std::memory_order_relaxed)
+       << " | invalid: " << invalid.load(std::memory_order_relaxed)
+       << " | resyncs: " << resyncs.load(std::memory_order_relaxed) << "\n";
+    ss << "Conversion ms (mean/p99/max): " << ns_to_ms(conversion_ns.mean())
+       << " / " << ns_to_ms(conversion_ns.percentile(0.99))
+       << " / " << ns_to_ms(conversion_ns.max.load(std::memory_order_relaxed)) << "\n";
+    ss << "Read-to-output ms (mean/p99/max): " << ns_to_ms(read_to_output_ns.mean())
+       << " / " << ns_to_ms(read_to_output_ns.percentile(0.99))
+       << " / " << ns_to_ms(read_to_output_ns.max.load(std::memory_order_relaxed)) << "\n";
+    ss << "Head lag (mean/p99/max): " << head_lag.mean()
+       << " / " << head_lag.percentile(0.99)
+       << " / " << head_lag.max.load(std::memory_order_relaxed);
+    return ss.str();
+}
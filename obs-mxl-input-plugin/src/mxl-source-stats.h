@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Lock-free power-of-two histogram. Bucket i holds samples in [2^(i-1), 2^i),
+// bucket 0 holds zero. Writers only touch relaxed atomics, so recording from
+// the capture thread never blocks a reader in the UI thread.
+struct mxl_histogram {
+    static constexpr int BUCKET_COUNT = 48;
+
+    std::atomic<uint64_t> buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+
+    mxl_histogram();
+
+    void reset();
+    void record(uint64_t value);
+
+    // Upper bound of the bucket holding the p-th percentile (0.0 - 1.0)
+    uint64_t percentile(double p) const;
+    uint64_t mean() const;
+};
+
+// Per-instance ingest statistics for one MXL source
+struct mxl_source_stats {
+    // Grains (video) or sample batches (audio) delivered to OBS
+    std::atomic<uint64_t> grains_read;
+    std::atomic<uint64_t> too_early;
+    std::atomic<uint64_t> too_late;
+    // Grains flagged invalid or only partially written
+    std::atomic<uint64_t> invalid;
+    // Read position realigned to the flow head
+    std::atomic<uint64_t> resyncs;
+    std::atomic<uint64_t> timeouts;
+    std::atomic<uint64_t> reopens;
+    std::atomic<uint64_t> errors;
+
+    // Nanoseconds spent converting a grain into the OBS frame/audio buffer
+    mxl_histogram conversion_ns;
+    // Nanoseconds from the grain being returned by MXL to it being handed to OBS
+    mxl_histogram read_to_output_ns;
+    // Distance between the flow head and the index being read (grains or samples)
+    mxl_histogram head_lag;
+
+    mxl_source_stats();
+
+    void reset();
+    std::string to_json() const;
+    std::string to_text() const;
+};
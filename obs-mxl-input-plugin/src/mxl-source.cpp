@@ -1,4 +1,7 @@
 #include "mxl-source.h"
+#include "mxl-profile.h"
+#include "mxl-v210.h"
+#include "mxl-audio.h"
 #include <obs-module.h>
 #include <util/platform.h>
 #include <util/threading.h>
@@ -22,6 +25,13 @@
 constexpr auto const FLOW_DIRECTORY_NAME_SUFFIX = ".mxl-flow";
 constexpr auto const FLOW_DESCRIPTOR_FILE_NAME = "flow_def.json";
 
+// Profiler scope names (the OBS profiler keys scopes by pointer)
+static const char *const PROFILE_VIDEO_GRAIN = "mxl_source_video_grain";
+static const char *const PROFILE_GET_GRAIN = "mxlFlowReaderGetGrain";
+static const char *const PROFILE_CONVERT_V210_TO_RGBA = "convert_v210_to_rgba";
+static const char *const PROFILE_AUDIO_BATCH = "mxl_source_audio_batch";
+static const char *const PROFILE_GET_SAMPLES = "mxlFlowReaderGetSamples";
+
 // Simple JSON parser for flow descriptor
 class SimpleJsonParser {
 public:
@@ -80,6 +90,8 @@ mxl_source_data::mxl_source_data()
     , format(VIDEO_FORMAT_NONE)
     , current_grain_index(0)
     , frame_interval_ns(33333333) // Default to ~30fps
+    , debug_grains_logged(0)
+    , frame_setup_logged(false)
 {
     memset(&flow_info, 0, sizeof(flow_info));
 }
@@ -97,6 +109,9 @@ mxl_source_data::~mxl_source_data()
 bool mxl_source_data::initialize_mxl()
 {
     cleanup_mxl();
+    stats.reset();
+    debug_grains_logged = 0;
+    frame_setup_logged = false;
     
     // Log version information
     blog(LOG_INFO, "MXL Source Plugin v%s [ID: %s] initializing flow %s", 
@@ -184,6 +199,12 @@ bool mxl_source_data::initialize_video(std::string& flow_descriptor)
         blog(LOG_ERROR, "MXL Source: Invalid video dimensions: %dx%d", width, height);
         return false;
     }
+    // Grains are unpacked as v210 only; anything else would show as noise
+    if (media_type != "video/v210") {
+        blog(LOG_ERROR, "MXL Source: Unsupported video media type '%s' (only video/v210 is read)",
+             media_type.c_str());
+        return false;
+    }
     
     // Calculate frame interval from grain rate
     if (flow_info.config.common.grainRate.numerator > 0) {
@@ -252,6 +273,16 @@ static uint64_t compute_read_delay_index(const mxlRational &rate, uint64_t read_
     return static_cast<uint64_t>(delay / denom);
 }
 
+void mxl_source_data::record_head_lag()
+{
+    mxlFlowRuntimeInfo runtime_info = {};
+    if (flow_reader && mxlFlowReaderGetRuntimeInfo(flow_reader, &runtime_info) == MXL_STATUS_OK) {
+        stats.head_lag.record(runtime_info.headIndex > current_grain_index
+            ? runtime_info.headIndex - current_grain_index
+            : 0);
+    }
+}
+
 static enum speaker_layout speaker_layout_from_channels(uint32_t channels)
 {
     switch (channels) {
@@ -274,6 +305,18 @@ static enum speaker_layout speaker_layout_from_channels(uint32_t channels)
     }
 }
 
+static mxl_audio_slice to_audio_slice(const mxlWrappedMultiBufferSlice &payload)
+{
+    mxl_audio_slice slice = {};
+    for (int frag = 0; frag < 2; ++frag) {
+        slice.fragments[frag].pointer = static_cast<const uint8_t*>(payload.base.fragments[frag].pointer);
+        slice.fragments[frag].size = payload.base.fragments[frag].size;
+    }
+    slice.stride = payload.stride;
+    slice.count = payload.count;
+    return slice;
+}
+
 void mxl_source_data::capture_loop_audio()
 {
     // Huge thx for mxl-gst tools from Riedel developers
@@ -299,15 +342,20 @@ void mxl_source_data::capture_loop_audio()
 
     uint64_t last_logged_index = 0;
     while (thread_active) {
+        mxl_profile_scope batch_scope(PROFILE_AUDIO_BATCH);
         mxlWrappedMultiBufferSlice payload;
-        status = mxlFlowReaderGetSamples(
-            flow_reader,
-            current_grain_index,
-            sample_amount,
-            mxlGetNsUntilIndex(current_grain_index + sample_amount, &rational_rate),
-            &payload);
+        {
+            mxl_profile_scope scope(PROFILE_GET_SAMPLES);
+            status = mxlFlowReaderGetSamples(
+                flow_reader,
+                current_grain_index,
+                sample_amount,
+                mxlGetNsUntilIndex(current_grain_index + sample_amount, &rational_rate),
+                &payload);
+        }
         if (status == MXL_ERR_OUT_OF_RANGE_TOO_EARLY) {
             // We are too early somehow, keep trying the same index
+            stats.too_early.fetch_add(1, std::memory_order_relaxed);
             if (current_grain_index != last_logged_index) {
                 mxlFlowReaderGetRuntimeInfo(flow_reader, &runtime_info);
                 blog(LOG_WARNING, "MXL Audio Source: Failed to get samples at index %" PRIu64 ": TOO EARLY. Last published %" PRIu64,
@@ -321,6 +369,8 @@ void mxl_source_data::capture_loop_audio()
         }
         else if (status == MXL_ERR_OUT_OF_RANGE_TOO_LATE) {
             // We are too late, that's too bad. Time travel!
+            stats.too_late.fetch_add(1, std::memory_order_relaxed);
+            stats.resyncs.fetch_add(1, std::memory_order_relaxed);
             if (current_grain_index != last_logged_index) {
                 blog(LOG_WARNING, "MXL Audio Source: Failed to get samples at index %" PRIu64 ": TOO LATE", current_grain_index);
                 last_logged_index = current_grain_index;
@@ -336,6 +386,7 @@ void mxl_source_data::capture_loop_audio()
         }
         else if (status == MXL_ERR_FLOW_INVALID) {
             blog(LOG_WARNING, "MXL Audio Source: Flow invalid, attempting to reopen reader");
+            stats.reopens.fetch_add(1, std::memory_order_relaxed);
             mxlReleaseFlowReader(mxl_instance, flow_reader);
             flow_reader = nullptr;
             if (mxlCreateFlowReader(mxl_instance, flow_id.c_str(), "", &flow_reader) == MXL_STATUS_OK) {
@@ -346,6 +397,7 @@ void mxl_source_data::capture_loop_audio()
             continue;
         }
         else if (status != MXL_STATUS_OK) {
+            stats.errors.fetch_add(1, std::memory_order_relaxed);
             blog(LOG_ERROR, "MXL Audio Source: Unexpected error when reading the grain %" PRIu64 " with status '%d'",
                 current_grain_index,
                 static_cast<int>(status)
@@ -354,6 +406,9 @@ void mxl_source_data::capture_loop_audio()
             continue;
         }
 
+        record_head_lag();
+        const uint64_t read_ns = os_gettime_ns();
+
         struct obs_source_audio audio = {};
         // Use payload channel count when available, cap to OBS max channels (8)
         output_channels = static_cast<uint32_t>(std::min<size_t>(payload.count, 8));
@@ -381,32 +436,16 @@ void mxl_source_data::capture_loop_audio()
             audio.data[ch] = audio_buffer + (ch * per_channel_bytes);
         }
 
+        const uint64_t copy_start_ns = os_gettime_ns();
+        float *planes[MAX_AV_PLANES] = {};
         for (uint32_t ch = 0; ch < output_channels; ++ch) {
-            if (ch >= payload.count) {
-                continue;
-            }
-            float *out = reinterpret_cast<float*>(audio_buffer + (ch * per_channel_bytes));
-            size_t out_frames_written = 0;
-
-            for (int frag = 0; frag < 2; ++frag) {
-                const auto frag_ptr = static_cast<const uint8_t*>(payload.base.fragments[frag].pointer);
-                const size_t frag_size = payload.base.fragments[frag].size;
-                if (!frag_ptr || frag_size == 0) {
-                    continue;
-                }
-
-                const float *src = reinterpret_cast<const float*>(frag_ptr + ch * payload.stride);
-                const size_t frag_frames = frag_size / sizeof(float);
-                const size_t remaining = sample_amount > out_frames_written ? (sample_amount - out_frames_written) : 0;
-                const size_t frames_to_copy = std::min(frag_frames, remaining);
-
-                std::memcpy(out + out_frames_written, src, frames_to_copy * sizeof(float));
-                out_frames_written += frames_to_copy;
-                if (out_frames_written >= sample_amount) {
-                    break;
-                }
-            }
+            planes[ch] = reinterpret_cast<float*>(audio_buffer + (ch * per_channel_bytes));
         }
+        mxl_audio_read_planar(to_audio_slice(payload), planes, output_channels, sample_amount);
+        const uint64_t output_ns = os_gettime_ns();
+        stats.conversion_ns.record(output_ns - copy_start_ns);
+        stats.read_to_output_ns.record(output_ns - read_ns);
+        stats.grains_read.fetch_add(1, std::memory_order_relaxed);
         obs_source_output_audio(source, &audio);
 
         current_grain_index += sample_amount;
@@ -440,16 +479,41 @@ void mxl_source_data::capture_loop_video()
         current_grain_index = 0;
     }
     
+    // When the grain being read was first seen with only some slices valid
+    uint64_t partial_since_ns = 0;
+    
     while (thread_active) {
+        mxl_profile_scope grain_scope(PROFILE_VIDEO_GRAIN);
         mxlGrainInfo grain_info;
         uint8_t *payload = nullptr;
         
         // Try to get the next grain with timeout
-        status = mxlFlowReaderGetGrain(flow_reader, current_grain_index, 
-                                      frame_interval_ns + 1000000, // Add 1ms margin
-                                      &grain_info, &payload);
+        {
+            mxl_profile_scope scope(PROFILE_GET_GRAIN);
+            status = mxlFlowReaderGetGrain(flow_reader, current_grain_index, 
+                                          frame_interval_ns + 1000000, // Add 1ms margin
+                                          &grain_info, &payload);
+        }
+        
+        // Writers that commit a grain in slice batches make it readable before
+        // its last lines are written; wait up to a frame interval for the rest
+        // instead of dropping it
+        if (status == MXL_STATUS_OK && payload && !(grain_info.flags & MXL_GRAIN_FLAG_INVALID) &&
+            grain_info.validSlices < grain_info.totalSlices) {
+            uint64_t now_ns = os_gettime_ns();
+            if (partial_since_ns == 0) {
+                partial_since_ns = now_ns;
+            }
+            if (now_ns - partial_since_ns < frame_interval_ns) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                continue;
+            }
+        }
+        partial_since_ns = 0;
         
         if (status == MXL_STATUS_OK && payload) {
+            record_head_lag();
+            const uint64_t read_ns = os_gettime_ns();
             if (process_grain_video(grain_info, payload)) {
                 // Create video frame structure for OBS
                 struct obs_source_frame frame = {};
@@ -464,24 +528,23 @@ void mxl_source_data::capture_loop_video()
                 frame.full_range = true;
                 
                 // Debug: log frame setup details once
-                static bool frame_debug_logged = false;
-                if (!frame_debug_logged) {
+                if (!frame_setup_logged) {
                     blog(LOG_INFO, "MXL Source: OBS Frame setup - width:%d height:%d format:RGBA", 
                          frame.width, frame.height);
                     blog(LOG_INFO, "MXL Source: Frame data pointer: %p, linesize: %d", 
                          frame.data[0], frame.linesize[0]);
-                    frame_debug_logged = true;
+                    frame_setup_logged = true;
                 }
                 
                 // Add some debug logging
-                static uint64_t frame_count = 0;
-                frame_count++;
+                uint64_t frame_count = stats.grains_read.fetch_add(1, std::memory_order_relaxed) + 1;
                 if (frame_count % 50 == 0) { // Log every 50 frames
                     blog(LOG_INFO, "MXL Source: Processed frame %" PRIu64 ", grain %" PRIu64, 
                          frame_count, current_grain_index);
                 }
                 
                 // Signal OBS that new frame is available
+                stats.read_to_output_ns.record(os_gettime_ns() - read_ns);
                 obs_source_output_video(source, &frame);
             } else {
                 blog(LOG_WARNING, "MXL Source: Failed to process grain %" PRIu64, current_grain_index);
@@ -489,14 +552,14 @@ void mxl_source_data::capture_loop_video()
             current_grain_index++;
         } else if (status == MXL_ERR_TIMEOUT) {
             // No new frame available, continue
-            static int timeout_count = 0;
-            timeout_count++;
+            uint64_t timeout_count = stats.timeouts.fetch_add(1, std::memory_order_relaxed) + 1;
             if (timeout_count % 100 == 0) { // Log every 100 timeouts
-                blog(LOG_DEBUG, "MXL Source: Timeout waiting for grain %" PRIu64 " (count: %d)", 
+                blog(LOG_DEBUG, "MXL Source: Timeout waiting for grain %" PRIu64 " (count: %" PRIu64 ")", 
                      current_grain_index, timeout_count);
             }
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
         } else if (status == MXL_ERR_OUT_OF_RANGE_TOO_EARLY) {
+            stats.too_early.fetch_add(1, std::memory_order_relaxed);
             if (mxlFlowReaderGetRuntimeInfo(flow_reader, &runtime_info) == MXL_STATUS_OK) {
                 blog(LOG_WARNING, "MXL Source: Failed to get grain %" PRIu64 ": TOO EARLY. Last published %" PRIu64,
                      current_grain_index, runtime_info.headIndex);
@@ -505,6 +568,8 @@ void mxl_source_data::capture_loop_video()
             }
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
         } else if (status == MXL_ERR_OUT_OF_RANGE_TOO_LATE) {
+            stats.too_late.fetch_add(1, std::memory_order_relaxed);
+            stats.resyncs.fetch_add(1, std::memory_order_relaxed);
             if (mxlFlowReaderGetRuntimeInfo(flow_reader, &runtime_info) == MXL_STATUS_OK) {
                 current_grain_index = runtime_info.headIndex > read_delay_grains
                     ? (runtime_info.headIndex - read_delay_grains)
@@ -516,6 +581,7 @@ void mxl_source_data::capture_loop_video()
             }
         } else if (status == MXL_ERR_FLOW_INVALID) {
             blog(LOG_WARNING, "MXL Source: Flow invalid, attempting to reopen reader");
+            stats.reopens.fetch_add(1, std::memory_order_relaxed);
             mxlReleaseFlowReader(mxl_instance, flow_reader);
             flow_reader = nullptr;
             if (mxlCreateFlowReader(mxl_instance, flow_id.c_str(), "", &flow_reader) == MXL_STATUS_OK) {
@@ -524,6 +590,7 @@ void mxl_source_data::capture_loop_video()
             }
             std::this_thread::sleep_for(std::chrono::milliseconds(500));
         } else {
+            stats.errors.fetch_add(1, std::memory_order_relaxed);
             blog(LOG_WARNING, "MXL Source: Failed to get grain %" PRIu64 " (status: %d)", 
                  current_grain_index, status);
             // Don't increment grain index on error, try the same grain again
@@ -539,30 +606,31 @@ bool mxl_source_data::process_grain_video(const mxlGrainInfo &grain_info, uint8_
     // Check if grain is marked as invalid
     if (grain_info.flags & MXL_GRAIN_FLAG_INVALID) {
         blog(LOG_DEBUG, "MXL Source: Received invalid grain, skipping");
+        stats.invalid.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
 
     if (!payload || grain_info.validSlices != grain_info.totalSlices) {
+        stats.invalid.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
     
     std::lock_guard<std::mutex> lock(frame_mutex);
     
     // Add debug info for first few frames
-    static int debug_count = 0;
-    if (debug_count < 5) {
+    if (debug_grains_logged < 5) {
         blog(LOG_INFO, "MXL Source: Processing grain size %u, first bytes: %02x %02x %02x %02x", 
              grain_info.grainSize, payload[0], payload[1], payload[2], payload[3]);
-        debug_count++;
+        if (debug_grains_logged == 0) {
+            blog(LOG_INFO, "MXL Source: Converting v210 data to RGBA format");
+        }
+        debug_grains_logged++;
     }
     
     // Convert v210 to RGBA
-    static bool logged_conversion = false;
-    if (!logged_conversion) {
-        blog(LOG_INFO, "MXL Source: Converting v210 data to RGBA format");
-        logged_conversion = true;
-    }
+    const uint64_t start_ns = os_gettime_ns();
     convert_v210_to_rgba(payload, grain_info.grainSize, frame_data, frame_size);
+    stats.conversion_ns.record(os_gettime_ns() - start_ns);
     
     return true;
 }
@@ -595,11 +663,31 @@ const char *mxl_source_get_name(void *unused)
     return "MXL Flow Source";
 }
 
+// Proc handler: "void get_stats(out string stats)" returns the ingest statistics as JSON
+static void mxl_source_proc_get_stats(void *data, calldata_t *cd)
+{
+    mxl_source_data *mxl_data = static_cast<mxl_source_data*>(data);
+    std::string json = mxl_data->stats.to_json();
+    calldata_set_string(cd, "stats", json.c_str());
+}
+
+// Proc handler: "void reset_stats()"
+static void mxl_source_proc_reset_stats(void *data, calldata_t *cd)
+{
+    UNUSED_PARAMETER(cd);
+    mxl_source_data *mxl_data = static_cast<mxl_source_data*>(data);
+    mxl_data->stats.reset();
+}
+
 void *mxl_source_create(obs_data_t *settings, obs_source_t *source)
 {
     mxl_source_data *data = new mxl_source_data();
     data->source = source;
     
+    proc_handler_t *ph = obs_source_get_proc_handler(source);
+    proc_handler_add(ph, "void get_stats(out string stats)", mxl_source_proc_get_stats, data);
+    proc_handler_add(ph, "void reset_stats()", mxl_source_proc_reset_stats, data);
+    
     mxl_source_update(data, settings);
     
     return data;
@@ -726,10 +814,71 @@ static bool restart_flow_clicked(obs_properties_t *props, obs_property_t *proper
     return true;
 }
 
-obs_properties_t *mxl_source_get_properties(void *data)
+static bool refresh_stats_clicked(obs_properties_t *props, obs_property_t *property, void *data)
+{
+    UNUSED_PARAMETER(property);
+    
+    struct mxl_source_data *mxl_data = (struct mxl_source_data *)data;
+    obs_property_t *stats_prop = obs_properties_get(props, "ingest_stats");
+    if (!mxl_data || !stats_prop) {
+        return false;
+    }
+    obs_property_set_description(stats_prop, mxl_data->stats.to_text().c_str());
+    return true;
+}
+
+static bool reset_stats_clicked(obs_properties_t *props, obs_property_t *property, void *data)
 {
+    struct mxl_source_data *mxl_data = (struct mxl_source_data *)data;
+    if (!mxl_data) {
+        return false;
+    }
+    mxl_data->stats.reset();
+    return refresh_stats_clicked(props, property, data);
+}
+
+static bool toggle_trace_clicked(obs_properties_t *props, obs_property_t *property, void *data)
+{
+    UNUSED_PARAMETER(props);
+    UNUSED_PARAMETER(data);
+    
+    bool enable = !mxl_trace_enabled();
+    if (enable) {
+        mxl_trace_clear();
+    }
+    mxl_trace_set_enabled(enable);
+    obs_property_set_description(property, enable ? "Stop hot-path tracing" : "Start hot-path tracing");
+    blog(LOG_INFO, "MXL Source: Hot-path tracing %s", enable ? "enabled" : "disabled");
+    return true;
+}
+
+static bool dump_trace_clicked(obs_properties_t *props, obs_property_t *property, void *data)
+{
+    UNUSED_PARAMETER(props);
+    UNUSED_PARAMETER(property);
     UNUSED_PARAMETER(data);
     
+    char *path = obs_module_config_path("mxl-input-trace.json");
+    if (!path) {
+        return false;
+    }
+    std::string trace_path(path);
+    bfree(path);
+    os_mkdirs(std::filesystem::path(trace_path).parent_path().string().c_str());
+    
+    int64_t events = mxl_trace_dump(trace_path, "obs-mxl-input-plugin");
+    if (events < 0) {
+        blog(LOG_ERROR, "MXL Source: Failed to write trace to %s", trace_path.c_str());
+    } else {
+        blog(LOG_INFO, "MXL Source: Wrote %" PRId64 " trace events to %s", events, trace_path.c_str());
+    }
+    return false;
+}
+
+obs_properties_t *mxl_source_get_properties(void *data)
+{
+    struct mxl_source_data *mxl_data = (struct mxl_source_data *)data;
+    
     obs_properties_t *props = obs_properties_create();
     
     // Add version information display
@@ -776,6 +925,18 @@ obs_properties_t *mxl_source_get_properties(void *data)
     // Add restart button
     obs_properties_add_button(props, "restart_flow_capture", "Restart flow capture", restart_flow_clicked);
     
+    // Ingest statistics for this source instance
+    std::string stats_text = mxl_data ? mxl_data->stats.to_text() : "No statistics available";
+    obs_properties_add_text(props, "ingest_stats", stats_text.c_str(), OBS_TEXT_INFO);
+    obs_properties_add_button(props, "refresh_stats", "Refresh statistics", refresh_stats_clicked);
+    obs_properties_add_button(props, "reset_stats", "Reset statistics", reset_stats_clicked);
+    
+    // Diagnostics: Chrome trace of the capture hot paths (shared by all MXL sources)
+    obs_properties_add_button(props, "toggle_trace",
+                              mxl_trace_enabled() ? "Stop hot-path tracing" : "Start hot-path tracing",
+                              toggle_trace_clicked);
+    obs_properties_add_button(props, "dump_trace", "Dump Chrome trace", dump_trace_clicked);
+    
     return props;
 }
 
@@ -823,94 +984,31 @@ void mxl_source_video_render(void *data, gs_effect_t *effect)
 void mxl_source_data::convert_v210_to_rgba(uint8_t *v210_data, size_t v210_size, 
                                            uint8_t *rgba_data, size_t rgba_size)
 {
+    mxl_profile_scope scope(PROFILE_CONVERT_V210_TO_RGBA);
+    
     // Convert v210 (10-bit YUV 4:2:2 packed) to RGBA
-    static bool debug_logged = false;
-    if (!debug_logged) {
+    if (debug_grains_logged == 1) {
         blog(LOG_INFO, "MXL Source: Converting v210 (%zu bytes) to RGBA (%zu bytes), dimensions %dx%d", 
              v210_size, rgba_size, width, height);
-        debug_logged = true;
     }
     
-    uint32_t *v210_words = (uint32_t*)v210_data;
-    uint32_t *rgba_pixels = (uint32_t*)rgba_data;
-    
-    // v210 packing: 4 32-bit words contain 6 pixels
-    size_t v210_words_per_line = ((width + 5) / 6) * 4;
-    
-    for (uint32_t line = 0; line < height; line++) {
-        uint32_t *line_start = v210_words + (line * v210_words_per_line);
-        
-        for (uint32_t x = 0; x < width; x += 6) {
-            uint32_t word_group = x / 6;
-            
-            if (word_group * 4 + 3 >= v210_words_per_line) break;
-            
-            uint32_t w0 = line_start[word_group * 4 + 0];
-            uint32_t w1 = line_start[word_group * 4 + 1];
-            uint32_t w2 = line_start[word_group * 4 + 2];
-            uint32_t w3 = line_start[word_group * 4 + 3];
-            
-            // Extract YUV values from v210 packing
-            // v210 format: Cb0 Y0 Cr0 | Y1 Cb1 Y2 | Cr1 Y3 Cb2 | Y4 Cr2 Y5
-            uint16_t cb0 = (w0 >> 0) & 0x3FF;   // U
-            uint16_t y0 = (w0 >> 10) & 0x3FF;   // Y
-            uint16_t cr0 = (w0 >> 20) & 0x3FF;  // V
-            
-            uint16_t y1 = (w1 >> 0) & 0x3FF;
-            uint16_t cb1 = (w1 >> 10) & 0x3FF;
-            uint16_t y2 = (w1 >> 20) & 0x3FF;
-            
-            uint16_t cr1 = (w2 >> 0) & 0x3FF;
-            uint16_t y3 = (w2 >> 10) & 0x3FF;
-            uint16_t cb2 = (w2 >> 20) & 0x3FF;
-            
-            uint16_t y4 = (w3 >> 0) & 0x3FF;
-            uint16_t cr2 = (w3 >> 10) & 0x3FF;
-            uint16_t y5 = (w3 >> 20) & 0x3FF;
-            
-            // Convert 10-bit to 8-bit
-            uint8_t y_vals[6] = {
-                (uint8_t)(y0 >> 2), (uint8_t)(y1 >> 2), (uint8_t)(y2 >> 2),
-                (uint8_t)(y3 >> 2), (uint8_t)(y4 >> 2), (uint8_t)(y5 >> 2)
-            };
-            
-            // Convert chroma values to 8-bit
-            uint8_t u_vals[3] = { (uint8_t)(cb0 >> 2), (uint8_t)(cb1 >> 2), (uint8_t)(cb2 >> 2) };
-            uint8_t v_vals[3] = { (uint8_t)(cr0 >> 2), (uint8_t)(cr1 >> 2), (uint8_t)(cr2 >> 2) };
-            
-            // Convert YUV to RGBA for each pixel
-            for (int i = 0; i < 6 && (x + i) < width; i++) {
-                uint32_t pixel_idx = line * width + x + i;
-                if (pixel_idx < width * height) {
-                    uint8_t y = y_vals[i];
-                    uint8_t u = u_vals[i / 2]; // 4:2:2 subsampling - 2 Y per UV
-                    uint8_t v = v_vals[i / 2];
-                    
-                    // Swap U and V to fix red/blue color swap
-                    uint8_t temp = u;
-                    u = v;
-                    v = temp;
-                    
-                    // YUV to RGB conversion using BT.709 coefficients
-                    float yf = (float)y;
-                    float uf = (float)u - 128.0f;
-                    float vf = (float)v - 128.0f;
-                    
-                    int r = (int)(yf + 1.5748f * vf);
-                    int g = (int)(yf - 0.1873f * uf - 0.4681f * vf);
-                    int b = (int)(yf + 1.8556f * uf);
-                    
-                    // Clamp to 0-255 range
-                    r = (r < 0) ? 0 : (r > 255) ? 255 : r;
-                    g = (g < 0) ? 0 : (g > 255) ? 255 : g;
-                    b = (b < 0) ? 0 : (b > 255) ? 255 : b;
-                    
-                    // RGBA format: A=255, R, G, B
-                    rgba_pixels[pixel_idx] = (255 << 24) | (r << 16) | (g << 8) | b;
-                }
-            }
-        }
+    // Writers may pad grain lines beyond the packed line (the output plugin
+    // packs at grainSize / height), so take the stride from the grain; only
+    // convert the lines both buffers actually hold
+    size_t v210_stride = v210_line_bytes(width);
+    if (height > 0 && v210_size / height > v210_stride) {
+        v210_stride = v210_size / height;
     }
+    size_t rgba_stride = static_cast<size_t>(width) * 4;
+    uint32_t lines = height;
+    if (v210_stride * lines > v210_size) {
+        lines = static_cast<uint32_t>(v210_size / v210_stride);
+    }
+    if (rgba_stride * lines > rgba_size) {
+        lines = static_cast<uint32_t>(rgba_size / rgba_stride);
+    }
+    
+    v210_unpack_to_rgba(v210_data, v210_stride, width, lines, rgba_data, rgba_stride);
 }
 
 // Flow discovery implementation
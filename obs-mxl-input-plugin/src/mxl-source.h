@@ -15,6 +15,7 @@
 #include <mutex>
 #include <vector>
 #include <filesystem>
+#include "mxl-source-stats.h"
 
 struct mxl_flow_info {
     std::string id;
@@ -63,6 +64,11 @@ struct mxl_source_data {
     // Timing
     uint64_t current_grain_index;
     uint64_t frame_interval_ns;
+
+    // Statistics (per instance, reset whenever the flow is (re)opened)
+    mxl_source_stats stats;
+    uint32_t debug_grains_logged;
+    bool frame_setup_logged;
     
     // Constructor/Destructor
     mxl_source_data();
@@ -85,6 +91,9 @@ struct mxl_source_data {
     std::vector<mxl_flow_info> discover_flows(const std::string &domain_path);
     mxl_flow_info get_flow_info_from_descriptor(const std::string &flow_id, const std::string &descriptor_path);
     bool is_flow_active(const std::string &domain_path, const std::string &flow_id);
+
+    // Head lag sampling for statistics
+    void record_head_lag();
 };
 
 // OBS source callbacks
@@ -1,5 +1,7 @@
 #include <obs-module.h>
 #include "mxl-source.h"
+#include "mxl-trace.h"
+#include <cstdlib>
 
 // Version information
 #define MXL_PLUGIN_VERSION "1.0.0"
@@ -14,6 +16,12 @@ bool obs_module_load(void)
     blog(LOG_INFO, "Loading MXL Plugin v%s (built %s) [ID: %s]", 
          MXL_PLUGIN_VERSION, MXL_BUILD_TIMESTAMP, MXL_BUILD_ID);
     
+    // OBS_MXL_TRACE=1 starts the hot-path tracer at load time
+    if (getenv("OBS_MXL_TRACE")) {
+        mxl_trace_set_enabled(true);
+        blog(LOG_INFO, "MXL Plugin: Hot-path tracing enabled (OBS_MXL_TRACE)");
+    }
+    
     struct obs_source_info mxl_source_info = {};
     
     mxl_source_info.id = "mxl_source";
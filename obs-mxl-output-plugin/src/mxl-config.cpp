@@ -20,7 +20,11 @@
 #include <util/config-file.h>
 #include <util/platform.h>
 #include <obs-module.h>
+#include <algorithm>
+#include <cctype>
 #include <cstdlib>
+#include <set>
+#include <sstream>
 
 MXLConfig* MXLConfig::_instance = nullptr;
 
@@ -30,7 +34,23 @@ MXLConfig::MXLConfig() :
     VideoEnabled(true),
     VideoFlowId(""),
     AudioEnabled(false),
-    AudioFlowId("")
+    AudioFlowId(""),
+    AudioMixers(1),
+    AudioTrackFlowIds(""),
+    AudioLayout("tracks"),
+    DirectGrainWrite(false),
+    VideoQueueDepth(2),
+    VideoDropPolicy("oldest"),
+    ConversionThreads(0),
+    VideoConversion("auto"),
+    VideoMediaType("v210"),
+    VideoSliceBatches(1),
+    VideoGapPolicy("invalid"),
+    Source(""),
+    OutputWidth(0),
+    OutputHeight(0),
+    ProxyScale(0),
+    ProxyFlowId("")
 {
     // Constructor - defaults are set above
     // Actual loading happens in Load() method
@@ -46,15 +66,7 @@ void MXLConfig::Load() {
     if (result == CONFIG_SUCCESS) {
         blog(LOG_INFO, "MXL Config: Successfully opened config file");
         
-        OutputEnabled = config_get_bool(config, MXL_SECTION_NAME, MXL_PARAM_OUTPUT_ENABLED);
-        const char* domain_path = config_get_string(config, MXL_SECTION_NAME, MXL_PARAM_DOMAIN_PATH);
-        const char* video_flow_id = config_get_string(config, MXL_SECTION_NAME, MXL_PARAM_VIDEO_FLOW_ID);
-        const char* audio_flow_id = config_get_string(config, MXL_SECTION_NAME, MXL_PARAM_AUDIO_FLOW_ID);
-        DomainPath = domain_path ? domain_path : DomainPath;
-        VideoEnabled = config_get_bool(config, MXL_SECTION_NAME, MXL_PARAM_VIDEO_ENABLED);
-        VideoFlowId = video_flow_id ? video_flow_id : VideoFlowId;
-        AudioEnabled = config_get_bool(config, MXL_SECTION_NAME, MXL_PARAM_AUDIO_ENABLED);
-        AudioFlowId = audio_flow_id ? audio_flow_id : AudioFlowId;
+        LoadSection(config, MXL_SECTION_NAME);
         
         blog(LOG_INFO, "MXL Config: Loaded - Output: %s, Domain: %s, Video: %s, Audio: %s",
              OutputEnabled ? "enabled" : "disabled",
@@ -62,12 +74,91 @@ void MXLConfig::Load() {
              VideoEnabled ? "enabled" : "disabled",
              AudioEnabled ? "enabled" : "disabled");
         
+        Profiles.clear();
+        const char* profiles = config_get_string(config, MXL_SECTION_NAME, MXL_PARAM_PROFILES);
+        std::stringstream names(profiles ? profiles : "");
+        std::string name;
+        // Outputs and config sections are looked up by name, so each one has
+        // to be unique; config sections ignore case
+        std::set<std::string> seen;
+        while (std::getline(names, name, ',')) {
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t") + 1);
+            if (name.empty()) {
+                blog(LOG_WARNING, "MXL Config: Ignoring an empty profile name in '%s'", profiles);
+                continue;
+            }
+            std::string key = name;
+            std::transform(key.begin(), key.end(), key.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (!seen.insert(key).second) {
+                blog(LOG_WARNING, "MXL Config: Ignoring duplicate profile name '%s'", name.c_str());
+                continue;
+            }
+            MXLConfig profile = *this;
+            profile.Profiles.clear();
+            profile.Name = name;
+            // Two writers can't share a flow, so flow IDs are never inherited
+            profile.VideoFlowId.clear();
+            profile.AudioFlowId.clear();
+            profile.AudioTrackFlowIds.clear();
+            profile.ProxyFlowId.clear();
+            profile.LoadSection(config, profile.SectionName().c_str());
+            blog(LOG_INFO, "MXL Config: Loaded profile '%s' - Output: %s, Domain: %s, Size: %dx%d",
+                 name.c_str(), profile.OutputEnabled ? "enabled" : "disabled", profile.DomainPath.c_str(),
+                 profile.OutputWidth, profile.OutputHeight);
+            Profiles.push_back(profile);
+        }
+        
         config_close(config);
     } else {
         blog(LOG_INFO, "MXL Config: Config file doesn't exist or failed to open (result: %d), using defaults", result);
     }
 }
 
+// Keys missing from `section` keep their current value
+void MXLConfig::LoadSection(config_t* config, const char* section) {
+    auto has = [&](const char* name) { return config_has_user_value(config, section, name); };
+    auto load_string = [&](const char* name, std::string &value) {
+        const char* str = config_get_string(config, section, name);
+        value = str ? str : value;
+    };
+    auto load_int = [&](const char* name, int &value) {
+        if (has(name)) {
+            value = static_cast<int>(config_get_int(config, section, name));
+        }
+    };
+    auto load_bool = [&](const char* name, bool &value) {
+        if (has(name)) {
+            value = config_get_bool(config, section, name);
+        }
+    };
+    
+    load_bool(MXL_PARAM_OUTPUT_ENABLED, OutputEnabled);
+    load_string(MXL_PARAM_DOMAIN_PATH, DomainPath);
+    load_bool(MXL_PARAM_VIDEO_ENABLED, VideoEnabled);
+    load_string(MXL_PARAM_VIDEO_FLOW_ID, VideoFlowId);
+    load_bool(MXL_PARAM_AUDIO_ENABLED, AudioEnabled);
+    load_string(MXL_PARAM_AUDIO_FLOW_ID, AudioFlowId);
+    load_int(MXL_PARAM_AUDIO_MIXERS, AudioMixers);
+    load_string(MXL_PARAM_AUDIO_TRACK_FLOW_IDS, AudioTrackFlowIds);
+    load_string(MXL_PARAM_AUDIO_LAYOUT, AudioLayout);
+    // Older config files don't have these keys; keep the defaults then
+    load_bool(MXL_PARAM_DIRECT_GRAIN_WRITE, DirectGrainWrite);
+    load_int(MXL_PARAM_VIDEO_QUEUE_DEPTH, VideoQueueDepth);
+    load_string(MXL_PARAM_VIDEO_DROP_POLICY, VideoDropPolicy);
+    load_int(MXL_PARAM_CONVERSION_THREADS, ConversionThreads);
+    load_string(MXL_PARAM_VIDEO_CONVERSION, VideoConversion);
+    load_string(MXL_PARAM_VIDEO_MEDIA_TYPE, VideoMediaType);
+    load_int(MXL_PARAM_VIDEO_SLICE_BATCHES, VideoSliceBatches);
+    load_string(MXL_PARAM_VIDEO_GAP_POLICY, VideoGapPolicy);
+    load_string(MXL_PARAM_SOURCE, Source);
+    load_int(MXL_PARAM_OUTPUT_WIDTH, OutputWidth);
+    load_int(MXL_PARAM_OUTPUT_HEIGHT, OutputHeight);
+    load_int(MXL_PARAM_PROXY_SCALE, ProxyScale);
+    load_string(MXL_PARAM_PROXY_FLOW_ID, ProxyFlowId);
+}
+
 void MXLConfig::Save() {
     std::string config_path = GetConfigPath();
     blog(LOG_INFO, "MXL Config: Saving to: %s", config_path.c_str());
@@ -84,6 +175,36 @@ void MXLConfig::Save() {
         config_set_string(config, MXL_SECTION_NAME, MXL_PARAM_VIDEO_FLOW_ID, VideoFlowId.c_str());
         config_set_bool(config, MXL_SECTION_NAME, MXL_PARAM_AUDIO_ENABLED, AudioEnabled);
         config_set_string(config, MXL_SECTION_NAME, MXL_PARAM_AUDIO_FLOW_ID, AudioFlowId.c_str());
+        config_set_int(config, MXL_SECTION_NAME, MXL_PARAM_AUDIO_MIXERS, AudioMixers);
+        config_set_string(config, MXL_SECTION_NAME, MXL_PARAM_AUDIO_TRACK_FLOW_IDS, AudioTrackFlowIds.c_str());
+        config_set_string(config, MXL_SECTION_NAME, MXL_PARAM_AUDIO_LAYOUT, AudioLayout.c_str());
+        config_set_bool(config, MXL_SECTION_NAME, MXL_PARAM_DIRECT_GRAIN_WRITE, DirectGrainWrite);
+        config_set_int(config, MXL_SECTION_NAME, MXL_PARAM_VIDEO_QUEUE_DEPTH, VideoQueueDepth);
+        config_set_string(config, MXL_SECTION_NAME, MXL_PARAM_VIDEO_DROP_POLICY, VideoDropPolicy.c_str());
+        config_set_int(config, MXL_SECTION_NAME, MXL_PARAM_CONVERSION_THREADS, ConversionThreads);
+        config_set_string(config, MXL_SECTION_NAME, MXL_PARAM_VIDEO_CONVERSION, VideoConversion.c_str());
+        config_set_string(config, MXL_SECTION_NAME, MXL_PARAM_VIDEO_MEDIA_TYPE, VideoMediaType.c_str());
+        config_set_int(config, MXL_SECTION_NAME, MXL_PARAM_VIDEO_SLICE_BATCHES, VideoSliceBatches);
+        config_set_string(config, MXL_SECTION_NAME, MXL_PARAM_VIDEO_GAP_POLICY, VideoGapPolicy.c_str());
+        config_set_string(config, MXL_SECTION_NAME, MXL_PARAM_SOURCE, Source.c_str());
+        config_set_int(config, MXL_SECTION_NAME, MXL_PARAM_OUTPUT_WIDTH, OutputWidth);
+        config_set_int(config, MXL_SECTION_NAME, MXL_PARAM_OUTPUT_HEIGHT, OutputHeight);
+        config_set_int(config, MXL_SECTION_NAME, MXL_PARAM_PROXY_SCALE, ProxyScale);
+        config_set_string(config, MXL_SECTION_NAME, MXL_PARAM_PROXY_FLOW_ID, ProxyFlowId.c_str());
+        // Profile sections are edited by hand; only their generated flow IDs
+        // are written back, so every other key keeps following the main profile
+        for (const MXLConfig& profile : Profiles) {
+            std::string section = profile.SectionName();
+            if (!profile.VideoFlowId.empty()) {
+                config_set_string(config, section.c_str(), MXL_PARAM_VIDEO_FLOW_ID, profile.VideoFlowId.c_str());
+            }
+            if (!profile.AudioFlowId.empty()) {
+                config_set_string(config, section.c_str(), MXL_PARAM_AUDIO_FLOW_ID, profile.AudioFlowId.c_str());
+            }
+            if (!profile.ProxyFlowId.empty()) {
+                config_set_string(config, section.c_str(), MXL_PARAM_PROXY_FLOW_ID, profile.ProxyFlowId.c_str());
+            }
+        }
         
         blog(LOG_INFO, "MXL Config: Saving - Output: %s, Domain: %s, Video: %s, Audio: %s",
              OutputEnabled ? "enabled" : "disabled",
@@ -104,6 +225,10 @@ void MXLConfig::Save() {
     }
 }
 
+std::string MXLConfig::SectionName() const {
+    return Name.empty() ? MXL_SECTION_NAME : MXL_PROFILE_SECTION_PREFIX + Name;
+}
+
 MXLConfig* MXLConfig::Current() {
     if (!_instance) {
         _instance = new MXLConfig();
@@ -20,15 +20,36 @@
 #define MXL_CONFIG_H
 
 #include <string>
+#include <vector>
 #include <obs-module.h>
+#include <util/config-file.h>
 
 #define MXL_SECTION_NAME "MXLPlugin"
+// Extra output profiles live in [MXLPlugin.<name>] sections
+#define MXL_PROFILE_SECTION_PREFIX MXL_SECTION_NAME "."
 #define MXL_PARAM_OUTPUT_ENABLED "OutputEnabled"
 #define MXL_PARAM_DOMAIN_PATH "DomainPath"
 #define MXL_PARAM_VIDEO_ENABLED "VideoEnabled"
 #define MXL_PARAM_VIDEO_FLOW_ID "VideoFlowId"
 #define MXL_PARAM_AUDIO_ENABLED "AudioEnabled"
 #define MXL_PARAM_AUDIO_FLOW_ID "AudioFlowId"
+#define MXL_PARAM_AUDIO_MIXERS "AudioMixers"
+#define MXL_PARAM_AUDIO_TRACK_FLOW_IDS "AudioTrackFlowIds"
+#define MXL_PARAM_AUDIO_LAYOUT "AudioLayout"
+#define MXL_PARAM_DIRECT_GRAIN_WRITE "DirectGrainWrite"
+#define MXL_PARAM_VIDEO_QUEUE_DEPTH "VideoQueueDepth"
+#define MXL_PARAM_VIDEO_DROP_POLICY "VideoDropPolicy"
+#define MXL_PARAM_CONVERSION_THREADS "ConversionThreads"
+#define MXL_PARAM_VIDEO_CONVERSION "VideoConversion"
+#define MXL_PARAM_VIDEO_MEDIA_TYPE "VideoMediaType"
+#define MXL_PARAM_VIDEO_SLICE_BATCHES "VideoSliceBatches"
+#define MXL_PARAM_OUTPUT_WIDTH "OutputWidth"
+#define MXL_PARAM_OUTPUT_HEIGHT "OutputHeight"
+#define MXL_PARAM_PROFILES "Profiles"
+#define MXL_PARAM_SOURCE "Source"
+#define MXL_PARAM_PROXY_SCALE "ProxyScale"
+#define MXL_PARAM_PROXY_FLOW_ID "ProxyFlowId"
+#define MXL_PARAM_VIDEO_GAP_POLICY "VideoGapPolicy"
 
 class MXLConfig {
 public:
@@ -37,15 +58,46 @@ public:
     void Load();
     void Save();
     std::string GetConfigPath();
+    // Config section this profile is read from
+    std::string SectionName() const;
 
+    // Empty for the main profile edited in the settings dialog
+    std::string Name;
     bool OutputEnabled;
     std::string DomainPath;
     bool VideoEnabled;
     std::string VideoFlowId;
     bool AudioEnabled;
     std::string AudioFlowId;
+    int AudioMixers;
+    std::string AudioTrackFlowIds;
+    std::string AudioLayout;
+    bool DirectGrainWrite;
+    int VideoQueueDepth;
+    std::string VideoDropPolicy;
+    int ConversionThreads;
+    std::string VideoConversion;
+    std::string VideoMediaType;
+    int VideoSliceBatches;
+    // "invalid" or "repeat": what fills grains OBS missed
+    std::string VideoGapPolicy;
+    // Scene or source to publish through its own view; empty = program
+    std::string Source;
+    // Flow resolution; 0 keeps OBS's output size
+    int OutputWidth;
+    int OutputHeight;
+    // Divisor (2, 4 or 8) of the companion proxy flow's size; 0 = no proxy
+    int ProxyScale;
+    std::string ProxyFlowId;
+
+    // Extra outputs named in the main section's Profiles key. Each one starts
+    // from the main profile's values except the flow IDs, and overrides them
+    // with the keys of its own section.
+    std::vector<MXLConfig> Profiles;
 
 private:
+    void LoadSection(config_t* config, const char* section);
+
     static MXLConfig* _instance;
 };
 
@@ -0,0 +1,104 @@
+#include "mxl-frame-pool.h"
+
+namespace {
+constexpr uint64_t TAG_INCREMENT = 1ULL << 32;
+
+uint64_t make_head(uint64_t old_head, uint32_t top)
+{
+    return ((old_head & ~0xFFFFFFFFULL) + TAG_INCREMENT) | top;
+}
+} // namespace
+
+void video_frame_deleter::operator()(video_frame_data *frame) const
+{
+    if (frame && frame->pool) {
+        frame->pool->recycle(frame);
+    } else {
+        delete frame;
+    }
+}
+
+mxl_frame_pool::mxl_frame_pool()
+    : head(0)
+    , count(0)
+{
+}
+
+mxl_frame_pool::~mxl_frame_pool()
+{
+    release();
+}
+
+bool mxl_frame_pool::allocate(uint32_t frame_count, enum video_format format, uint32_t width, uint32_t height)
+{
+    release();
+    if (frame_count == 0 || width == 0 || height == 0) {
+        return false;
+    }
+
+    frames.reset(new video_frame_data[frame_count]);
+    next.reset(new std::atomic<uint32_t>[frame_count]);
+    for (uint32_t i = 0; i < frame_count; i++) {
+        video_frame_init(&frames[i].planes, format, width, height);
+        if (!frames[i].planes.data[0]) {
+            blog(LOG_ERROR, "MXL Output: Cannot allocate pooled frames for video format %d", format);
+            count = i;
+            release();
+            return false;
+        }
+        frames[i].width = width;
+        frames[i].height = height;
+        frames[i].format = format;
+        frames[i].pool = this;
+        next[i].store(i, std::memory_order_relaxed);
+    }
+    count = frame_count;
+    head.store(frame_count, std::memory_order_release);
+
+    blog(LOG_INFO, "MXL Output: Allocated %u pooled %ux%u video frames (format %d)", frame_count, width, height,
+         format);
+    return true;
+}
+
+void mxl_frame_pool::release()
+{
+    if (!frames) {
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        video_frame_free(&frames[i].planes);
+    }
+    frames.reset();
+    next.reset();
+    head.store(0, std::memory_order_relaxed);
+    count = 0;
+}
+
+video_frame_ptr mxl_frame_pool::acquire()
+{
+    uint64_t old_head = head.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t top = static_cast<uint32_t>(old_head);
+        if (top == 0) {
+            return video_frame_ptr();
+        }
+        // next[] may be rewritten by a concurrent recycle; the tag makes the CAS fail then
+        uint32_t below = next[top - 1].load(std::memory_order_relaxed);
+        if (head.compare_exchange_weak(old_head, make_head(old_head, below),
+                                       std::memory_order_acquire, std::memory_order_acquire)) {
+            video_frame_data *frame = &frames[top - 1];
+            frame->timestamp = 0;
+            return video_frame_ptr(frame);
+        }
+    }
+}
+
+void mxl_frame_pool::recycle(video_frame_data *frame)
+{
+    uint32_t index = static_cast<uint32_t>(frame - frames.get());
+    uint64_t old_head = head.load(std::memory_order_relaxed);
+    do {
+        next[index].store(static_cast<uint32_t>(old_head), std::memory_order_relaxed);
+    } while (!head.compare_exchange_weak(old_head, make_head(old_head, index + 1),
+                                         std::memory_order_release, std::memory_order_relaxed));
+}
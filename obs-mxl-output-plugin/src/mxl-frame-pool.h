@@ -0,0 +1,67 @@
+#pragma once
+
+#include <obs-module.h>
+#include <media-io/video-io.h>
+#include <media-io/video-frame.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+struct mxl_frame_pool;
+
+// A copy of one OBS output frame in its native format, waiting for the
+// output thread to convert it into a grain
+struct video_frame_data {
+    struct video_frame planes;
+    uint64_t timestamp;
+    uint32_t width;
+    uint32_t height;
+    enum video_format format;
+    // Owning pool, or nullptr when the planes were allocated for this frame only
+    mxl_frame_pool *pool;
+
+    video_frame_data() : planes{}, timestamp(0), width(0), height(0), format(VIDEO_FORMAT_NONE), pool(nullptr) {}
+    ~video_frame_data() {
+        if (!pool) {
+            video_frame_free(&planes);
+        }
+    }
+    video_frame_data(const video_frame_data&) = delete;
+    video_frame_data& operator=(const video_frame_data&) = delete;
+};
+
+// Hands pooled frames back to their pool instead of deleting them
+struct video_frame_deleter {
+    void operator()(video_frame_data *frame) const;
+};
+
+using video_frame_ptr = std::unique_ptr<video_frame_data, video_frame_deleter>;
+
+// Fixed set of preallocated frames of one format and size. Free frames sit
+// on a lock-free stack (index + ABA tag packed into one 64-bit word), so the
+// OBS video thread and the output thread can acquire and recycle frames
+// without locking or touching the heap.
+struct mxl_frame_pool {
+    mxl_frame_pool();
+    ~mxl_frame_pool();
+    mxl_frame_pool(const mxl_frame_pool&) = delete;
+    mxl_frame_pool& operator=(const mxl_frame_pool&) = delete;
+
+    // Not thread safe; call while no frames are in flight
+    bool allocate(uint32_t count, enum video_format format, uint32_t width, uint32_t height);
+    void release();
+
+    // Returns nullptr when every frame is in use
+    video_frame_ptr acquire();
+    void recycle(video_frame_data *frame);
+
+    uint32_t capacity() const { return count; }
+
+private:
+    std::unique_ptr<video_frame_data[]> frames;
+    std::unique_ptr<std::atomic<uint32_t>[]> next;
+    // Low 32 bits: top frame index + 1 (0 = empty), high 32 bits: tag
+    std::atomic<uint64_t> head;
+    uint32_t count;
+};
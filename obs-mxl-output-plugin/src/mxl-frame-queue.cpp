@@ -0,0 +1,109 @@
+#include "mxl-frame-queue.h"
+#include <cstring>
+
+const char *mxl_drop_policy_name(mxl_drop_policy policy)
+{
+    return policy == MXL_DROP_NEWEST ? "newest" : "oldest";
+}
+
+mxl_drop_policy mxl_drop_policy_from_name(const char *name)
+{
+    return name && strcmp(name, "newest") == 0 ? MXL_DROP_NEWEST : MXL_DROP_OLDEST;
+}
+
+mxl_frame_queue::mxl_frame_queue()
+    : slot_count(0)
+    , drop_policy(MXL_DROP_OLDEST)
+    , read_index(0)
+    , write_index(0)
+{
+}
+
+mxl_frame_queue::~mxl_frame_queue()
+{
+    clear();
+}
+
+void mxl_frame_queue::reset(uint32_t capacity, mxl_drop_policy policy)
+{
+    clear();
+    slots.reset(capacity ? new std::atomic<video_frame_data*>[capacity] : nullptr);
+    for (uint32_t i = 0; i < capacity; i++) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+    slot_count = capacity;
+    drop_policy = policy;
+    read_index.store(0, std::memory_order_relaxed);
+    write_index.store(0, std::memory_order_relaxed);
+}
+
+void mxl_frame_queue::clear()
+{
+    while (pop()) {
+    }
+}
+
+bool mxl_frame_queue::push(video_frame_ptr frame)
+{
+    if (!frame) {
+        return true;
+    }
+    if (slot_count == 0) {
+        return false;
+    }
+
+    bool dropped = false;
+    uint64_t write = write_index.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t read = read_index.load(std::memory_order_acquire);
+        if (write - read < slot_count) {
+            break;
+        }
+        if (drop_policy == MXL_DROP_NEWEST) {
+            return false; // frame goes back to its pool here
+        }
+        // Race the consumer for the oldest slot; whoever advances read_index owns it
+        video_frame_data *oldest = slots[read % slot_count].load(std::memory_order_relaxed);
+        if (read_index.compare_exchange_strong(read, read + 1, std::memory_order_acq_rel)) {
+            video_frame_ptr evicted(oldest);
+            dropped = true;
+            break;
+        }
+    }
+
+    slots[write % slot_count].store(frame.release(), std::memory_order_relaxed);
+    write_index.store(write + 1, std::memory_order_release);
+    return !dropped;
+}
+
+video_frame_ptr mxl_frame_queue::pop()
+{
+    if (slot_count == 0) {
+        return video_frame_ptr();
+    }
+
+    uint64_t read = read_index.load(std::memory_order_acquire);
+    for (;;) {
+        if (read == write_index.load(std::memory_order_acquire)) {
+            return video_frame_ptr();
+        }
+        video_frame_data *frame = slots[read % slot_count].load(std::memory_order_relaxed);
+        // Fails if the producer evicted this slot meanwhile; read is reloaded then
+        if (read_index.compare_exchange_weak(read, read + 1, std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+            return video_frame_ptr(frame);
+        }
+    }
+}
+
+bool mxl_frame_queue::empty() const
+{
+    return read_index.load(std::memory_order_acquire) == write_index.load(std::memory_order_acquire);
+}
+
+size_t mxl_frame_queue::size() const
+{
+    uint64_t write = write_index.load(std::memory_order_acquire);
+    uint64_t read = read_index.load(std::memory_order_acquire);
+    return write > read ? static_cast<size_t>(write - read) : 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "mxl-frame-pool.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+enum mxl_drop_policy {
+    MXL_DROP_OLDEST, // a full queue evicts its oldest frame for the new one
+    MXL_DROP_NEWEST, // a full queue rejects the new frame
+};
+
+const char *mxl_drop_policy_name(mxl_drop_policy policy);
+mxl_drop_policy mxl_drop_policy_from_name(const char *name);
+
+// Fixed-capacity frame ring between the OBS video callback (single producer)
+// and the output thread (single consumer). Both sides claim the oldest slot
+// with a CAS on the read index, which lets the producer evict it under
+// MXL_DROP_OLDEST without a lock. Dropped frames are returned to their pool;
+// counting them is left to the caller.
+struct mxl_frame_queue {
+    mxl_frame_queue();
+    ~mxl_frame_queue();
+    mxl_frame_queue(const mxl_frame_queue&) = delete;
+    mxl_frame_queue& operator=(const mxl_frame_queue&) = delete;
+
+    // Not thread safe; drops whatever is still queued
+    void reset(uint32_t capacity, mxl_drop_policy policy);
+    void clear();
+
+    // Producer side; returns false when a frame (old or new) was dropped
+    bool push(video_frame_ptr frame);
+    // Consumer side; empty pointer when nothing is queued
+    video_frame_ptr pop();
+
+    bool empty() const;
+    size_t size() const;
+    uint32_t capacity() const { return slot_count; }
+
+private:
+    std::unique_ptr<std::atomic<video_frame_data*>[]> slots;
+    uint32_t slot_count;
+    mxl_drop_policy drop_policy;
+    std::atomic<uint64_t> read_index;
+    std::atomic<uint64_t> write_index;
+};
@@ -1,8 +1,11 @@
 #include "mxl-output.h"
 #include "mxl-config.h"
+#include "mxl-profile.h"
+#include "mxl-view.h"
 #include <random>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 #include <inttypes.h>
 
 namespace {
@@ -27,6 +30,62 @@ namespace {
             return 2;
         }
     }
+
+    // Profiler scope name (the OBS profiler keys scopes by pointer)
+    const char *const PROFILE_COPY_VIDEO_FRAME = "copy_video_frame";
+
+    // Comma-separated flow IDs; empty entries keep their position
+    std::vector<std::string> split_flow_ids(const char *list)
+    {
+        std::vector<std::string> ids;
+        if (!list || !*list) {
+            return ids;
+        }
+        std::stringstream ss(list);
+        std::string id;
+        while (std::getline(ss, id, ',')) {
+            id.erase(0, id.find_first_not_of(" \t"));
+            id.erase(id.find_last_not_of(" \t") + 1);
+            ids.push_back(id);
+        }
+        return ids;
+    }
+
+    // Points the output back at the program mix before dropping the view,
+    // so it never refers to a destroyed video_t
+    void release_view(mxl_output_data *data)
+    {
+        if (!data->view_video) {
+            return;
+        }
+        obs_output_set_media(data->output, obs_get_video(), obs_get_audio());
+        mxl_view_release(data->view_video);
+        data->view_video = nullptr;
+    }
+
+    // Tears down everything the raw callbacks use: writers, pools, audio
+    // tracks, the MXL instance and the view
+    void finish_output(mxl_output_data *data)
+    {
+        data->cleanup_mxl();
+        release_view(data);
+        blog(LOG_INFO, "MXL Output: Output stopped - %" PRIu64 " video grains written, %" PRIu64 " repeated, %" PRIu64
+             " frames dropped", data->video_grain_index.load(), data->repeated_video_grains.load(),
+             data->dropped_video_frames.load());
+    }
+
+    // libobs disconnects raw video and audio on its own thread after
+    // obs_output_end_data_capture returns, waiting for callbacks in flight,
+    // and signals "deactivate" once it is done; only then can the state
+    // they use go away
+    void on_output_deactivate(void *data, calldata_t *cd)
+    {
+        UNUSED_PARAMETER(cd);
+        mxl_output_data *output_data = static_cast<mxl_output_data*>(data);
+        if (output_data->capture_active.exchange(false)) {
+            finish_output(output_data);
+        }
+    }
 }
 
 // Forward declaration for callback functions
@@ -60,6 +119,7 @@ void *mxl_output_create(obs_data_t *settings, obs_output_t *output)
     
     mxl_output_data *data = new mxl_output_data();
     data->output = output;
+    signal_handler_connect(obs_output_get_signal_handler(output), "deactivate", on_output_deactivate, data);
     
     // Get settings
     data->domain_path = obs_data_get_string(settings, "domain_path");
@@ -67,6 +127,48 @@ void *mxl_output_create(obs_data_t *settings, obs_output_t *output)
     data->video_enabled = obs_data_get_bool(settings, "video_enabled");
     data->audio_flow_id = obs_data_get_string(settings, "audio_flow_id");
     data->audio_enabled = obs_data_get_bool(settings, "audio_enabled");
+    if (obs_data_has_user_value(settings, "audio_mixers")) {
+        data->audio_mixers = static_cast<uint32_t>(obs_data_get_int(settings, "audio_mixers")) &
+                             ((1u << MAX_AUDIO_MIXES) - 1);
+    }
+    data->audio_track_flow_ids = split_flow_ids(obs_data_get_string(settings, "audio_track_flow_ids"));
+    data->audio_layout = mxl_audio_layout_from_name(obs_data_get_string(settings, "audio_layout"));
+    if (obs_data_has_user_value(settings, "direct_grain_write")) {
+        data->direct_grain_write = obs_data_get_bool(settings, "direct_grain_write");
+    }
+    if (obs_data_has_user_value(settings, "video_queue_depth")) {
+        long long depth = obs_data_get_int(settings, "video_queue_depth");
+        data->video_queue_depth = static_cast<uint32_t>(
+            std::clamp<long long>(depth, 1, MXL_VIDEO_QUEUE_DEPTH_MAX));
+    }
+    data->video_drop_policy = mxl_drop_policy_from_name(obs_data_get_string(settings, "video_drop_policy"));
+    long long threads = obs_data_get_int(settings, "conversion_threads");
+    data->convert_threads = static_cast<uint32_t>(std::clamp<long long>(threads, 0, 16));
+    data->video_conversion = mxl_video_conversion_from_name(obs_data_get_string(settings, "video_conversion"));
+    data->video_packing = mxl_video_packing_from_name(obs_data_get_string(settings, "video_media_type"));
+    const char *view_source = obs_data_get_string(settings, "view_source");
+    data->view_source = view_source ? view_source : "";
+    long long proxy_scale = obs_data_get_int(settings, "proxy_scale");
+    data->proxy_scale = static_cast<uint32_t>(std::clamp<long long>(proxy_scale, 0, 8));
+    data->proxy_flow_id = obs_data_get_string(settings, "proxy_flow_id");
+    data->video_gap_policy = mxl_video_gap_policy_from_name(obs_data_get_string(settings, "video_gap_policy"));
+    if (obs_data_has_user_value(settings, "video_slice_batches")) {
+        long long batches = obs_data_get_int(settings, "video_slice_batches");
+        data->video_slice_batches = static_cast<uint32_t>(
+            std::clamp<long long>(batches, 1, MXL_VIDEO_SLICE_BATCHES_MAX));
+    }
+    if (data->direct_grain_write) {
+        blog(LOG_INFO, "MXL Output: Video grains written directly from the video callback");
+    } else {
+        blog(LOG_INFO, "MXL Output: Video grains written through the output queue (depth %u, drop %s)",
+             data->video_queue_depth, mxl_drop_policy_name(data->video_drop_policy));
+    }
+    if (data->video_slice_batches > 1) {
+        blog(LOG_INFO, "MXL Output: Video grains committed in %u slice batches", data->video_slice_batches);
+    }
+    if (data->video_gap_policy == MXL_GAP_REPEAT) {
+        blog(LOG_INFO, "MXL Output: Missed video grains repeat the last frame");
+    }
     
     // Get video info from OBS
     obs_video_info ovi;
@@ -79,6 +181,15 @@ void *mxl_output_create(obs_data_t *settings, obs_output_t *output)
         data->video_format = ovi.output_format;
         data->video_media_type = data->get_mxl_video_media_type(ovi.output_format);
         
+        // Profiles with their own size get frames scaled by OBS, see
+        // choose_video_conversion; v210 and 4:2:0 sources need even sizes
+        long long width = obs_data_get_int(settings, "output_width");
+        long long height = obs_data_get_int(settings, "output_height");
+        if (width > 0 && height > 0) {
+            data->video_width = static_cast<uint32_t>(std::clamp<long long>(width, 2, 16384)) & ~1u;
+            data->video_height = static_cast<uint32_t>(std::clamp<long long>(height, 2, 16384)) & ~1u;
+        }
+        
         // Calculate video frame interval
         if (ovi.fps_num > 0) {
             data->video_frame_interval_ns = (1000000000ULL * ovi.fps_den) / ovi.fps_num;
@@ -93,7 +204,9 @@ void *mxl_output_create(obs_data_t *settings, obs_output_t *output)
     }
 
     
-    blog(LOG_INFO, "MXL Output: Created output instance - Video: %dx%d@%.2ffps, Audio: %u Hz, %u ch",
+    const char *profile = obs_data_get_string(settings, "profile_name");
+    blog(LOG_INFO, "MXL Output: Created output instance%s%s - Video: %dx%d@%.2ffps, Audio: %u Hz, %u ch",
+         profile && *profile ? " for profile " : "", profile ? profile : "",
          data->video_width, data->video_height,
          (double)data->video_fps_num / data->video_fps_den,
          data->audio_sample_rate, data->audio_channel_count);
@@ -107,6 +220,13 @@ void mxl_output_destroy(void *data)
     
     mxl_output_data *output_data = static_cast<mxl_output_data*>(data);
     if (output_data) {
+        // OBS has joined the end capture thread by now
+        signal_handler_disconnect(obs_output_get_signal_handler(output_data->output), "deactivate",
+                                  on_output_deactivate, output_data);
+        if (output_data->capture_active.exchange(false)) {
+            finish_output(output_data);
+        }
+        release_view(output_data);
         delete output_data;
     }
 }
@@ -127,31 +247,102 @@ bool mxl_output_start(void *data)
         return false;
     }
     
-    // Connect to OBS video sources
+    // Ask OBS for frames the v210 packers read directly; the frame pool
+    // below is sized for whatever format this settles on
     obs_output_t *output = output_data->output;
+    obs_video_info ovi;
+    struct video_scale_info conversion = {};
+    bool convert = false;
+    if (obs_get_video_info(&ovi)) {
+        convert = output_data->choose_video_conversion(ovi, conversion);
+        output_data->video_format = convert ? conversion.format : ovi.output_format;
+    }
     
-    // Connect to video
+    // A source output captures its view, which renders straight into the
+    // flow's size and format; outputs wanting the same frames share the view
+    // A view kept by a run whose capture never began is dropped here
+    release_view(output_data);
     video_t *video = obs_get_video();
+    if (!output_data->view_source.empty() && output_data->video_enabled) {
+        struct video_scale_info view_format = conversion;
+        if (!convert) {
+            view_format.format = ovi.output_format;
+            view_format.width = output_data->video_width;
+            view_format.height = output_data->video_height;
+            view_format.range = ovi.range;
+            view_format.colorspace = ovi.colorspace;
+        }
+        obs_video_info view_ovi;
+        video = mxl_view_acquire(output_data->view_source, view_format, view_ovi);
+        if (!video) {
+            output_data->cleanup_mxl();
+            return false;
+        }
+        output_data->view_video = video;
+        obs_output_set_media(output, video, obs_get_audio());
+        convert = false;
+    }
+    // The proxy needs the negotiated frame format; the main flow runs without it
+    if (!output_data->create_proxy_flow()) {
+        blog(LOG_WARNING, "MXL Output: Continuing without the proxy flow");
+    }
+    blog(LOG_INFO, "MXL Output: %s flow, video conversion %s, frames arrive as %s%s%s",
+         output_data->video_media_type.c_str(), mxl_video_conversion_name(output_data->video_conversion),
+         convert || output_data->view_video ? get_video_format_name(output_data->video_format) : "OBS output format",
+         output_data->view_video ? " from the view of " : "", output_data->view_video ? output_data->view_source.c_str() : "");
+    
+    // Band workers for the v210 pack, sized for the negotiated resolution
+    uint32_t convert_threads = output_data->convert_threads;
+    if (convert_threads == 0) {
+        convert_threads = mxl_band_auto_threads(output_data->video_width, output_data->video_height);
+    }
+    output_data->convert_pool.start(convert_threads);
+    blog(LOG_INFO, "MXL Output: Converting video with %u thread(s)", output_data->convert_pool.thread_count());
+    
+    // Preallocate the queued path's frames for the negotiated format and resolution
+    if (output_data->video_enabled && !output_data->direct_grain_write) {
+        output_data->video_queue.reset(output_data->video_queue_depth, output_data->video_drop_policy);
+        if (!output_data->video_pool.allocate(output_data->video_pool_size(), output_data->video_format,
+                                              output_data->video_width, output_data->video_height)) {
+            blog(LOG_ERROR, "MXL Output: Failed to allocate video frame pool");
+            output_data->cleanup_mxl();
+            release_view(output_data);
+            return false;
+        }
+    }
+    
+    // Connect to video
     if (video) {
-        obs_output_set_video_conversion(output, nullptr);
+        obs_output_set_video_conversion(output, convert ? &conversion : nullptr);
     }
 
     
+    // One raw_audio2 stream per selected mixer, each into its own flow
+    if (output_data->audio_enabled) {
+        obs_output_set_mixers(output, output_data->audio_mixers);
+    }
+    
     // Start data capture
+    bool capturing = false;
     if (video) {
-        obs_output_begin_data_capture(output, 0);
+        capturing = obs_output_begin_data_capture(output, 0);
     }
     
-    // Start output thread
+    // Start output thread; the time base is in place before the first frame
+    output_data->reset_time_base();
     output_data->thread_active = true;
     output_data->output_active = true;
     output_data->start_timestamp = output_data->get_timestamp_ns();
     output_data->video_grain_index = 0;
-    output_data->video_grain_index = 0;
+    output_data->dropped_video_frames = 0;
+    output_data->repeated_video_grains = 0;
+    output_data->received_video_frames = 0;
+    output_data->pool_empty_count = 0;
+    output_data->last_logged_video_grain = 0;
+    output_data->conversion_logged = false;
+    output_data->unsupported_format_logged = false;
     output_data->last_grain_index_valid = false;
-    output_data->last_audio_index_valid = false;
-    output_data->audio_has_time_offset = false;
-    output_data->has_time_offset = false;
+    output_data->capture_active = capturing;
     
     try {
         output_data->output_thread = std::thread(&mxl_output_data::output_loop, output_data);
@@ -161,6 +352,13 @@ bool mxl_output_start(void *data)
         blog(LOG_ERROR, "MXL Output: Failed to start output thread: %s", e.what());
         output_data->thread_active = false;
         output_data->output_active = false;
+        // Callbacks may already be running; the deactivate signal tears down
+        if (capturing) {
+            obs_output_end_data_capture(output);
+        } else {
+            output_data->cleanup_mxl();
+            release_view(output_data);
+        }
         return false;
     }
     
@@ -177,15 +375,14 @@ void mxl_output_stop(void *data, uint64_t ts)
         return;
     }
     
-    // Stop data capture first
-    if (output_data->output) {
+    // Callbacks arriving until capture has ended drop their data; the
+    // deactivate signal then tears down what they were using
+    output_data->output_active = false;
+    if (output_data->capture_active) {
         obs_output_end_data_capture(output_data->output);
+    } else {
+        finish_output(output_data);
     }
-    
-    output_data->output_active = false;
-    output_data->cleanup_mxl();
-    
-    blog(LOG_INFO, "MXL Output: Output stopped");
 }
 
 void mxl_output_raw_video(void *data, struct video_data *frame)
@@ -195,52 +392,57 @@ void mxl_output_raw_video(void *data, struct video_data *frame)
         return;
     }
     
-    static uint64_t frame_count = 0;
-    frame_count++;
+    uint64_t frame_count = ++output_data->received_video_frames;
     
     if (frame_count % 300 == 1) { // Log every 300th frame (every 10 seconds at 30fps)
         blog(LOG_DEBUG, "MXL Output: Received video frame %" PRIu64 " (timestamp: %" PRIu64 ")", 
              frame_count, frame->timestamp);
     }
     
-    // Create video frame data
-    auto video_frame = std::make_unique<video_frame_data>();
-    video_frame->width = output_data->video_width;
-    video_frame->height = output_data->video_height;
-    video_frame->format = output_data->video_format;
-    video_frame->timestamp = frame->timestamp;
-    
-    // Calculate v210 frame size
-    video_frame->size = output_data->calculate_video_frame_size(
-        video_frame->format, video_frame->width, video_frame->height);
-    
-    // Allocate v210 frame buffer
-    video_frame->data = static_cast<uint8_t*>(bmalloc(video_frame->size));
-    if (!video_frame->data) {
-        blog(LOG_ERROR, "MXL Output: Failed to allocate video frame buffer");
+    // Convert straight into the grain payload on this thread
+    if (output_data->direct_grain_write) {
+        if (!output_data->write_video_frame_direct(frame)) {
+            output_data->dropped_video_frames.fetch_add(1);
+            blog(LOG_WARNING, "MXL Output: Failed to write video frame %" PRIu64 " to grain", frame_count);
+        }
         return;
     }
     
-    // Convert to v210 format
-    
-    if (!output_data->convert_to_v210(frame->data[0], video_frame->format,
-                                     video_frame->width, video_frame->height,
-                                     frame->linesize, video_frame->data, video_frame->size,
-                                     frame->data)) {
-        blog(LOG_ERROR, "MXL Output: Failed to convert video frame to v210");
+    // Take a preallocated frame; no heap allocation on this path
+    video_frame_ptr video_frame = output_data->video_pool.acquire();
+    if (!video_frame) {
+        output_data->dropped_video_frames.fetch_add(1);
+        if (output_data->pool_empty_count++ % 100 == 0) {
+            blog(LOG_WARNING, "MXL Output: Video frame pool exhausted, dropping frame (%" PRIu64 " so far)",
+                 output_data->pool_empty_count);
+        }
         return;
     }
     
-    // Add to queue
+    // Only copy the planes here; conversion and commit run on the output thread
     {
-        std::lock_guard<std::mutex> lock(output_data->video_queue_mutex);
-        output_data->video_queue.push(std::move(video_frame));
-        
-        if (frame_count % 300 == 1) {
-            blog(LOG_DEBUG, "MXL Output: Video queue size: %zu", output_data->video_queue.size());
+        mxl_profile_scope scope(PROFILE_COPY_VIDEO_FRAME);
+        struct video_frame source = {};
+        for (int i = 0; i < MAX_AV_PLANES; i++) {
+            source.data[i] = frame->data[i];
+            source.linesize[i] = frame->linesize[i];
         }
+        video_frame_copy(&video_frame->planes, &source, video_frame->format, video_frame->height);
+        video_frame->timestamp = frame->timestamp;
+    }
+    
+    // Add to queue; a full ring drops the oldest or this frame per the policy
+    if (!output_data->video_queue.push(std::move(video_frame))) {
+        output_data->dropped_video_frames.fetch_add(1);
+    }
+    
+    if (frame_count % 300 == 1) {
+        blog(LOG_DEBUG, "MXL Output: Video queue size: %zu, dropped: %" PRIu64,
+             output_data->video_queue.size(), output_data->dropped_video_frames.load());
     }
     
+    // Taking the wait mutex orders this push against the consumer's empty check
+    { std::lock_guard<std::mutex> lock(output_data->video_queue_mutex); }
     output_data->frame_condition.notify_one();
 }
 
@@ -267,36 +469,59 @@ uint64_t mxl_output_get_total_bytes(void *data)
 
 int mxl_output_get_dropped_frames(void *data)
 {
-    UNUSED_PARAMETER(data);
-    // For now, we don't track dropped frames
-    return 0;
+    mxl_output_data *output_data = static_cast<mxl_output_data*>(data);
+    if (!output_data) {
+        return 0;
+    }
+    
+    return static_cast<int>(output_data->dropped_video_frames.load());
 }
 
 void mxl_output_raw_audio2(void *data, size_t idx, struct audio_data *frames)
 {
-    UNUSED_PARAMETER(idx);
     mxl_output_data *output_data = static_cast<mxl_output_data*>(data);
     if (!output_data || !output_data->output_active || !output_data->audio_enabled || !frames) {
         return;
     }
-    output_data->write_audio_samples(frames);
+    // Each mixer goes to its own flow, or to its channels of the wide flow;
+    // tracks are never summed
+    mxl_audio_track *track = output_data->audio_track_for(idx);
+    if (!track) {
+        return;
+    }
+    if (track->wide_mixers) {
+        output_data->write_wide_audio_samples(*track, idx, frames);
+    } else {
+        output_data->write_audio_samples(*track, frames);
+    }
 }
 
 void mxl_output_raw_audio(void *data, struct audio_data *frames)
 {
     mxl_output_data *output_data = static_cast<mxl_output_data*>(data);
-    if (!output_data || !output_data->output_active || !output_data->audio_enabled || !frames) {
+    if (!output_data || !output_data->output_active || !output_data->audio_enabled || !frames ||
+        output_data->audio_tracks.empty()) {
         return;
     }
-    output_data->write_audio_samples(frames);
+    output_data->write_audio_samples(output_data->audio_tracks.front(), frames);
 }
 
 void mxl_output_update(void *data, obs_data_t *settings)
 {
     mxl_output_data *output_data = static_cast<mxl_output_data*>(data);
     
-    // Update configuration from settings
-    MXLConfig* config = MXLConfig::Current();
+    // Update configuration from settings; outputs of extra profiles update
+    // their own profile
+    MXLConfig* main_config = MXLConfig::Current();
+    MXLConfig* config = main_config;
+    const char *profile_name = obs_data_get_string(settings, "profile_name");
+    if (profile_name && *profile_name) {
+        for (MXLConfig &profile : main_config->Profiles) {
+            if (profile.Name == profile_name) {
+                config = &profile;
+            }
+        }
+    }
     
     config->DomainPath = obs_data_get_string(settings, "domain_path");
     config->OutputEnabled = obs_data_get_bool(settings, "output_enabled");
@@ -304,9 +529,58 @@ void mxl_output_update(void *data, obs_data_t *settings)
     config->VideoFlowId = obs_data_get_string(settings, "video_flow_id");
     config->AudioEnabled = obs_data_get_bool(settings, "audio_enabled");
     config->AudioFlowId = obs_data_get_string(settings, "audio_flow_id");
+    // Write path settings apply on the next start; the running output keeps its own
+    if (obs_data_has_user_value(settings, "direct_grain_write")) {
+        config->DirectGrainWrite = obs_data_get_bool(settings, "direct_grain_write");
+    }
+    if (obs_data_has_user_value(settings, "video_queue_depth")) {
+        config->VideoQueueDepth = static_cast<int>(obs_data_get_int(settings, "video_queue_depth"));
+    }
+    if (obs_data_has_user_value(settings, "video_drop_policy")) {
+        config->VideoDropPolicy = obs_data_get_string(settings, "video_drop_policy");
+    }
+    if (obs_data_has_user_value(settings, "conversion_threads")) {
+        config->ConversionThreads = static_cast<int>(obs_data_get_int(settings, "conversion_threads"));
+    }
+    if (obs_data_has_user_value(settings, "video_conversion")) {
+        config->VideoConversion = obs_data_get_string(settings, "video_conversion");
+    }
+    if (obs_data_has_user_value(settings, "video_media_type")) {
+        config->VideoMediaType = obs_data_get_string(settings, "video_media_type");
+    }
+    if (obs_data_has_user_value(settings, "audio_mixers")) {
+        config->AudioMixers = static_cast<int>(obs_data_get_int(settings, "audio_mixers"));
+    }
+    if (obs_data_has_user_value(settings, "audio_track_flow_ids")) {
+        config->AudioTrackFlowIds = obs_data_get_string(settings, "audio_track_flow_ids");
+    }
+    if (obs_data_has_user_value(settings, "audio_layout")) {
+        config->AudioLayout = obs_data_get_string(settings, "audio_layout");
+    }
+    if (obs_data_has_user_value(settings, "video_slice_batches")) {
+        config->VideoSliceBatches = static_cast<int>(obs_data_get_int(settings, "video_slice_batches"));
+    }
+    if (obs_data_has_user_value(settings, "view_source")) {
+        config->Source = obs_data_get_string(settings, "view_source");
+    }
+    if (obs_data_has_user_value(settings, "video_gap_policy")) {
+        config->VideoGapPolicy = obs_data_get_string(settings, "video_gap_policy");
+    }
+    if (obs_data_has_user_value(settings, "proxy_scale")) {
+        config->ProxyScale = static_cast<int>(obs_data_get_int(settings, "proxy_scale"));
+    }
+    if (obs_data_has_user_value(settings, "proxy_flow_id")) {
+        config->ProxyFlowId = obs_data_get_string(settings, "proxy_flow_id");
+    }
+    if (obs_data_has_user_value(settings, "output_width")) {
+        config->OutputWidth = static_cast<int>(obs_data_get_int(settings, "output_width"));
+    }
+    if (obs_data_has_user_value(settings, "output_height")) {
+        config->OutputHeight = static_cast<int>(obs_data_get_int(settings, "output_height"));
+    }
     
     // Save to file
-    config->Save();
+    main_config->Save();
     
     // Update the output data if it exists
     if (output_data) {
@@ -316,11 +590,6 @@ void mxl_output_update(void *data, obs_data_t *settings)
         output_data->audio_flow_id = config->AudioFlowId;
         output_data->audio_enabled = config->AudioEnabled;
     }
-    
-    // In a full implementation, you might want to:
-    // - Create separate MXL flows for each video track
-    // - Mix multiple tracks into a single output
-    // - Allow user configuration of which tracks to use
 }
 
 } // extern "C"
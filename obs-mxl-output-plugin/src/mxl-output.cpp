@@ -1,8 +1,14 @@
 #include "mxl-output.h"
+#include "mxl-profile.h"
+#include "mxl-v210.h"
+#include "mxl-uyvy.h"
+#include "mxl-audio.h"
 #include <obs-module.h>
 #include <util/platform.h>
 #include <util/threading.h>
 #include <mxl/time.h>
+#include <algorithm>
+#include <bitset>
 #include <filesystem>
 #include <fstream>
 #include <chrono>
@@ -12,6 +18,7 @@
 #include <inttypes.h>
 #include <unistd.h>
 #include <cstring>
+#include <cctype>
 
 namespace {
 const char *mxl_status_to_string(mxlStatus status)
@@ -39,6 +46,98 @@ const char *mxl_status_to_string(mxlStatus status)
     default: return "MXL_STATUS_UNKNOWN_CODE";
     }
 }
+
+mxl_audio_mutable_slice to_audio_slice(const mxlMutableWrappedMultiBufferSlice &payload)
+{
+    mxl_audio_mutable_slice slice = {};
+    for (int frag = 0; frag < 2; ++frag) {
+        slice.fragments[frag].pointer = static_cast<uint8_t*>(payload.base.fragments[frag].pointer);
+        slice.fragments[frag].size = payload.base.fragments[frag].size;
+    }
+    slice.stride = payload.stride;
+    slice.count = payload.count;
+    return slice;
+}
+
+// Downscale and pack of the proxy grain, riding along with a main pack
+struct proxy_band_job {
+    const v210_source *source;
+    uint32_t factor;
+    downscale_frame frame;
+    // `frame` seen as a packer source
+    v210_source packed;
+    uint8_t *dst;
+    size_t dst_stride;
+    v210_isa isa;
+    bool uyvy;
+};
+
+struct v210_band_job {
+    const v210_source *source;
+    uint8_t *dst;
+    size_t dst_stride;
+    v210_isa isa;
+    // First frame row of the batch the bands are split from
+    uint32_t row_offset;
+    // nullptr when no proxy flow is written
+    const proxy_band_job *proxy;
+};
+
+// OBS output formats the v210 packers read directly
+bool to_v210_source_format(enum video_format format, v210_source_format &source_format)
+{
+    switch (format) {
+    case VIDEO_FORMAT_NV12: source_format = V210_SOURCE_NV12; return true;
+    case VIDEO_FORMAT_I420: source_format = V210_SOURCE_I420; return true;
+    case VIDEO_FORMAT_I422: source_format = V210_SOURCE_I422; return true;
+    case VIDEO_FORMAT_I444: source_format = V210_SOURCE_I444; return true;
+    case VIDEO_FORMAT_P010: source_format = V210_SOURCE_P010; return true;
+    case VIDEO_FORMAT_I010: source_format = V210_SOURCE_I010; return true;
+    case VIDEO_FORMAT_RGBA: source_format = V210_SOURCE_RGBA; return true;
+    case VIDEO_FORMAT_BGRA: source_format = V210_SOURCE_BGRA; return true;
+    case VIDEO_FORMAT_P216: source_format = V210_SOURCE_P216; return true;
+    case VIDEO_FORMAT_I210: source_format = V210_SOURCE_I210; return true;
+    default: return false;
+    }
+}
+
+// Proxy row pairs belong to the band holding their first source row, so
+// bands and slice batches split the proxy without overlap while the source
+// rows they read are still warm in cache
+void pack_proxy_rows(const proxy_band_job &job, uint32_t src_begin, uint32_t src_end)
+{
+    uint32_t span = 2 * job.factor;
+    uint32_t begin = (src_begin + span - 1) / span * 2;
+    uint32_t end = std::min((src_end + span - 1) / span * 2, job.frame.height);
+    if (begin >= end || !downscale_rows(*job.source, job.factor, job.frame, begin, end)) {
+        return;
+    }
+    if (job.uyvy) {
+        uyvy_pack_rows(job.packed, job.dst, job.dst_stride, begin, end);
+    } else {
+        v210_pack_rows(job.packed, job.dst, job.dst_stride, job.isa, begin, end);
+    }
+}
+
+void pack_v210_band(void *context, uint32_t row_begin, uint32_t row_end)
+{
+    const v210_band_job *job = static_cast<const v210_band_job*>(context);
+    v210_pack_rows(*job->source, job->dst, job->dst_stride, job->isa,
+                   job->row_offset + row_begin, job->row_offset + row_end);
+    if (job->proxy) {
+        pack_proxy_rows(*job->proxy, job->row_offset + row_begin, job->row_offset + row_end);
+    }
+}
+
+void pack_uyvy_band(void *context, uint32_t row_begin, uint32_t row_end)
+{
+    const v210_band_job *job = static_cast<const v210_band_job*>(context);
+    uyvy_pack_rows(*job->source, job->dst, job->dst_stride,
+                   job->row_offset + row_begin, job->row_offset + row_end);
+    if (job->proxy) {
+        pack_proxy_rows(*job->proxy, job->row_offset + row_begin, job->row_offset + row_end);
+    }
+}
 } // namespace
 
 // Version and build information
@@ -50,16 +149,41 @@ const char *mxl_status_to_string(mxlStatus status)
 constexpr auto const FLOW_DIRECTORY_NAME_SUFFIX = ".mxl-flow";
 constexpr auto const FLOW_DESCRIPTOR_FILE_NAME = ".json";
 
+// Profiler scope names (the OBS profiler keys scopes by pointer)
+static const char *const PROFILE_PROCESS_VIDEO_FRAME = "process_video_frame";
+static const char *const PROFILE_WRITE_VIDEO_DIRECT = "write_video_frame_direct";
+static const char *const PROFILE_WRITE_AUDIO_SAMPLES = "write_audio_samples";
+static const char *const PROFILE_CONVERT_TO_V210 = "convert_to_v210";
+static const char *const PROFILE_CONVERT_TO_UYVY = "convert_to_uyvy";
+
 // Constructor
 mxl_output_data::mxl_output_data()
     : output(nullptr)
     , mxl_instance(nullptr)
     , video_flow_writer(nullptr)
     , flow_config{}
-    , audio_flow_writer(nullptr)
-    , audio_flow_config{}
+    , audio_track_for_mix{}
+    , audio_mixers(MXL_AUDIO_MIXERS_DEFAULT)
+    , audio_layout(MXL_AUDIO_LAYOUT_TRACKS)
     , video_enabled(true)
     , audio_enabled(false)
+    , direct_grain_write(false)
+    , video_queue_depth(MXL_VIDEO_QUEUE_DEPTH_DEFAULT)
+    , video_drop_policy(MXL_DROP_OLDEST)
+    , convert_threads(0)
+    , video_conversion(MXL_CONVERSION_AUTO)
+    , video_packing(MXL_PACKING_V210)
+    , video_slice_batches(1)
+    , video_gap_policy(MXL_GAP_INVALID)
+    , view_video(nullptr)
+    , proxy_scale(0)
+    , proxy_flow_writer(nullptr)
+    , proxy_flow_config{}
+    , proxy_width(0)
+    , proxy_height(0)
+    , proxy_frame{}
+    , proxy_payload(nullptr)
+    , proxy_stride(0)
     , video_width(0)
     , video_height(0)
     , video_fps_num(30)
@@ -69,18 +193,23 @@ mxl_output_data::mxl_output_data()
     , audio_channel_count(0)
     , thread_active(false)
     , output_active(false)
+    , capture_active(false)
+    , dropped_video_frames(0)
+    , repeated_video_grains(0)
+    , received_video_frames(0)
+    , pool_empty_count(0)
+    , last_logged_video_grain(0)
+    , conversion_logged(false)
+    , unsupported_format_logged(false)
     , video_grain_index(0)
     , last_grain_index(0)
     , last_grain_index_valid(false)
-    , mxl_time_offset_ns(0)
-    , has_time_offset(false)
-    , last_audio_index_end(0)
-    , last_audio_index_valid(false)
-    , audio_time_offset_ns(0)
-    , audio_has_time_offset(false)
     , start_timestamp(0)
     , video_frame_interval_ns(33333333) // Default to ~30fps
 {
+    for (int &track : audio_track_for_mix) {
+        track = -1;
+    }
 }
 
 // Destructor
@@ -158,6 +287,10 @@ bool mxl_output_data::initialize_mxl()
         video_flow_id = generate_uuid();
         blog(LOG_INFO, "MXL Output: Generated video flow ID: %s", video_flow_id.c_str());
     }
+    if (video_enabled && proxy_scale > 1 && proxy_flow_id.empty()) {
+        proxy_flow_id = generate_uuid();
+        blog(LOG_INFO, "MXL Output: Generated proxy flow ID: %s", proxy_flow_id.c_str());
+    }
     if (audio_enabled && audio_flow_id.empty()) {
         audio_flow_id = generate_uuid();
         blog(LOG_INFO, "MXL Output: Generated audio flow ID: %s", audio_flow_id.c_str());
@@ -168,8 +301,8 @@ bool mxl_output_data::initialize_mxl()
         blog(LOG_ERROR, "MXL Output: Failed to create video flow");
         return false;
     }
-    if (audio_enabled && !create_audio_flow()) {
-        blog(LOG_ERROR, "MXL Output: Failed to create audio flow");
+    if (audio_enabled && !create_audio_flows()) {
+        blog(LOG_ERROR, "MXL Output: Failed to create audio flows");
         return false;
     }
     
@@ -188,22 +321,38 @@ void mxl_output_data::cleanup_mxl()
         }
     }
     
-    // Clear frame queues
-    {
-        std::lock_guard<std::mutex> lock(video_queue_mutex);
-        while (!video_queue.empty()) {
-            video_queue.pop();
-        }
-    }
+    // Queued frames go back to the pool before it is freed
+    video_queue.clear();
+    video_pool.release();
+    convert_pool.stop();
     
     // Release MXL resources
+    close_repeat_source(repeat_video);
+    close_repeat_source(repeat_proxy);
     if (video_flow_writer) {
         mxlReleaseFlowWriter(mxl_instance, video_flow_writer);
         video_flow_writer = nullptr;
     }
-    if (audio_flow_writer) {
-        mxlReleaseFlowWriter(mxl_instance, audio_flow_writer);
-        audio_flow_writer = nullptr;
+    if (proxy_flow_writer) {
+        mxlReleaseFlowWriter(mxl_instance, proxy_flow_writer);
+        proxy_flow_writer = nullptr;
+    }
+    proxy_payload = nullptr;
+    proxy_buffer.reset();
+    proxy_frame = {};
+    for (mxl_audio_track &track : audio_tracks) {
+        if (track.wide_open) {
+            mxlFlowWriterCancelSamples(track.writer);
+            track.wide_open = false;
+        }
+        if (track.writer) {
+            mxlReleaseFlowWriter(mxl_instance, track.writer);
+            track.writer = nullptr;
+        }
+    }
+    audio_tracks.clear();
+    for (int &track : audio_track_for_mix) {
+        track = -1;
     }
     
     if (mxl_instance) {
@@ -235,6 +384,18 @@ bool mxl_output_data::create_video_flow()
         &video_flow_writer,
         &flow_config,
         &created);
+    if (status != MXL_STATUS_OK && video_packing == MXL_PACKING_UYVY) {
+        // MXL SDK releases so far parse video/v210 and video/v210a only; the
+        // frame format is negotiated after this, so v210 can still take over
+        blog(LOG_WARNING, "MXL Output: MXL SDK rejected the video/raw flow %s (status: %d %s), writing v210 instead",
+             video_flow_id.c_str(), status, mxl_status_to_string(status));
+        video_packing = MXL_PACKING_V210;
+        video_media_type = get_mxl_video_media_type(video_format);
+        flow_descriptor = generate_flow_descriptor_json(true);
+        flow_config = {};
+        status = mxlCreateFlowWriter(mxl_instance, flow_descriptor.c_str(), "", &video_flow_writer, &flow_config,
+                                     &created);
+    }
     if (status != MXL_STATUS_OK) {
         blog(LOG_ERROR, "MXL Output: Failed to create video flow writer for flow: %s (status: %d %s)", 
              video_flow_id.c_str(), status, mxl_status_to_string(status));
@@ -260,66 +421,209 @@ bool mxl_output_data::create_video_flow()
         video_frame_interval_ns = (1000000000ULL * flow_config.common.grainRate.denominator) /
                                   flow_config.common.grainRate.numerator;
     }
+    if (video_gap_policy == MXL_GAP_REPEAT) {
+        open_repeat_source(repeat_video, video_flow_id);
+    }
     
     return true;
 }
 
-bool mxl_output_data::create_audio_flow()
+bool mxl_output_data::create_proxy_flow()
+{
+    if (!video_enabled || proxy_scale <= 1 || !video_flow_writer) {
+        return true;
+    }
+    if (!downscale_factor_valid(proxy_scale)) {
+        blog(LOG_ERROR, "MXL Output: Proxy scale must be 2, 4 or 8 (got %u)", proxy_scale);
+        return false;
+    }
+    v210_source_format source_format;
+    if (!to_v210_source_format(video_format, source_format) || !downscale_supported(source_format)) {
+        blog(LOG_ERROR, "MXL Output: Proxy flow needs 8-bit NV12, I420 or I422 frames (got %s)",
+             get_video_format_name(video_format));
+        return false;
+    }
+    proxy_width = downscale_dim(video_width, proxy_scale);
+    proxy_height = downscale_dim(video_height, proxy_scale);
+    if (proxy_width == 0 || proxy_height == 0) {
+        blog(LOG_ERROR, "MXL Output: %ux%u is too small for a 1/%u proxy", video_width, video_height, proxy_scale);
+        return false;
+    }
+
+    std::string flow_descriptor = generate_video_descriptor_json(proxy_flow_id, proxy_width, proxy_height,
+                                                                 "MXL Video Proxy", video_flow_id);
+    proxy_flow_config = {};
+    bool created = false;
+    mxlStatus status = mxlCreateFlowWriter(
+        mxl_instance,
+        flow_descriptor.c_str(),
+        "",
+        &proxy_flow_writer,
+        &proxy_flow_config,
+        &created);
+    if (status != MXL_STATUS_OK) {
+        blog(LOG_ERROR, "MXL Output: Failed to create proxy flow writer for flow: %s (status: %d %s)",
+             proxy_flow_id.c_str(), status, mxl_status_to_string(status));
+        return false;
+    }
+    if (!created || proxy_flow_config.common.format != MXL_DATA_FORMAT_VIDEO) {
+        blog(LOG_ERROR, "MXL Output: Proxy flow %s already has a writer or is not video", proxy_flow_id.c_str());
+        mxlReleaseFlowWriter(mxl_instance, proxy_flow_writer);
+        proxy_flow_writer = nullptr;
+        return false;
+    }
+
+    proxy_buffer.reset(new uint8_t[downscale_frame_size(source_format, proxy_width, proxy_height)]);
+    downscale_frame_init(proxy_frame, source_format, proxy_width, proxy_height, proxy_buffer.get());
+    if (video_gap_policy == MXL_GAP_REPEAT) {
+        open_repeat_source(repeat_proxy, proxy_flow_id);
+    }
+    blog(LOG_INFO, "MXL Output: Proxy flow %s at %ux%u (1/%u)", proxy_flow_id.c_str(), proxy_width,
+         proxy_height, proxy_scale);
+    return true;
+}
+
+bool mxl_output_data::create_audio_flows()
 {
     if (!audio_enabled || audio_flow_id.empty()) {
         return true;
     }
 
+    audio_tracks.clear();
+    for (size_t mix = 0; mix < MAX_AUDIO_MIXES; mix++) {
+        audio_track_for_mix[mix] = -1;
+        if (!(audio_mixers & (1u << mix))) {
+            continue;
+        }
+        mxl_audio_track track;
+        track.mix_idx = mix;
+        if (audio_tracks.empty()) {
+            track.flow_id = audio_flow_id;
+        } else if (audio_tracks.size() - 1 < audio_track_flow_ids.size() &&
+                   !audio_track_flow_ids[audio_tracks.size() - 1].empty()) {
+            track.flow_id = audio_track_flow_ids[audio_tracks.size() - 1];
+        } else {
+            track.flow_id = mxl_derive_track_flow_id(audio_flow_id, mix);
+        }
+        audio_track_for_mix[mix] = static_cast<int>(audio_tracks.size());
+        audio_tracks.push_back(track);
+    }
+    if (audio_tracks.empty()) {
+        blog(LOG_WARNING, "MXL Output: Audio enabled but no mixer selected (mask 0x%x)", audio_mixers);
+        return true;
+    }
+
+    // Fold the tracks into one flow on AudioFlowId, one channel group per mixer
+    if (audio_layout == MXL_AUDIO_LAYOUT_WIDE && audio_tracks.size() > 1) {
+        mxl_audio_track wide;
+        wide.mix_idx = audio_tracks.front().mix_idx;
+        wide.flow_id = audio_flow_id;
+        wide.channels_per_mixer = audio_channel_count;
+        wide.channel_count = audio_channel_count * static_cast<uint32_t>(audio_tracks.size());
+        for (const mxl_audio_track &track : audio_tracks) {
+            wide.wide_mixers |= 1u << track.mix_idx;
+            audio_track_for_mix[track.mix_idx] = 0;
+        }
+        audio_tracks.assign(1, wide);
+        if (!create_audio_flow(audio_tracks.front())) {
+            return false;
+        }
+        blog(LOG_INFO, "MXL Output: Audio mixers 0x%x -> wide flow %s (%u channels)", wide.wide_mixers,
+             wide.flow_id.c_str(), audio_tracks.front().channel_count);
+        return true;
+    }
+
+    for (mxl_audio_track &track : audio_tracks) {
+        if (!create_audio_flow(track)) {
+            return false;
+        }
+        blog(LOG_INFO, "MXL Output: Audio track %zu -> flow %s", track.mix_idx + 1, track.flow_id.c_str());
+    }
+    return true;
+}
+
+bool mxl_output_data::create_audio_flow(mxl_audio_track &track)
+{
     if (audio_sample_rate == 0 || audio_channel_count == 0) {
         blog(LOG_ERROR, "MXL Output: Invalid audio settings (rate:%u channels:%u)",
              audio_sample_rate, audio_channel_count);
         return false;
     }
 
-    std::string flow_descriptor = generate_flow_descriptor_json(false);
-    audio_flow_config = {};
+    if (track.channel_count == 0) {
+        track.channel_count = audio_channel_count;
+    }
+    std::string flow_descriptor = generate_flow_descriptor_json(false, &track);
+    track.config = {};
     bool created = false;
     mxlStatus status = mxlCreateFlowWriter(
         mxl_instance,
         flow_descriptor.c_str(),
         "",
-        &audio_flow_writer,
-        &audio_flow_config,
+        &track.writer,
+        &track.config,
         &created);
     if (status != MXL_STATUS_OK) {
         blog(LOG_ERROR, "MXL Output: Failed to create audio flow writer for flow: %s (status: %d %s)",
-             audio_flow_id.c_str(), status, mxl_status_to_string(status));
+             track.flow_id.c_str(), status, mxl_status_to_string(status));
         blog(LOG_ERROR, "MXL Output: Audio flow descriptor: %s", flow_descriptor.c_str());
         return false;
     }
     if (!created) {
         blog(LOG_ERROR, "MXL Output: Audio flow writer not created (flow already has an active writer): %s",
-             audio_flow_id.c_str());
-        mxlReleaseFlowWriter(mxl_instance, audio_flow_writer);
-        audio_flow_writer = nullptr;
+             track.flow_id.c_str());
+        mxlReleaseFlowWriter(mxl_instance, track.writer);
+        track.writer = nullptr;
         return false;
     }
-    if (audio_flow_config.common.format != MXL_DATA_FORMAT_AUDIO) {
-        blog(LOG_ERROR, "MXL Output: Flow is not audio (format: %u)", audio_flow_config.common.format);
-        mxlReleaseFlowWriter(mxl_instance, audio_flow_writer);
-        audio_flow_writer = nullptr;
+    if (track.config.common.format != MXL_DATA_FORMAT_AUDIO) {
+        blog(LOG_ERROR, "MXL Output: Flow is not audio (format: %u)", track.config.common.format);
+        mxlReleaseFlowWriter(mxl_instance, track.writer);
+        track.writer = nullptr;
         return false;
     }
 
-    if (audio_flow_config.common.grainRate.numerator > 0) {
-        int32_t denom = audio_flow_config.common.grainRate.denominator;
+    if (track.config.continuous.channelCount > 0) {
+        if (track.wide_mixers && track.config.continuous.channelCount != track.channel_count) {
+            blog(LOG_WARNING, "MXL Output: Wide audio flow %s has %u channels, expected %u; extra mixers are dropped",
+                 track.flow_id.c_str(), track.config.continuous.channelCount, track.channel_count);
+        }
+        track.channel_count = track.config.continuous.channelCount;
+    }
+    // An existing flow keeps its rate; the first track's rate is reported
+    if (&track == &audio_tracks.front() && track.config.common.grainRate.numerator > 0) {
+        int32_t denom = track.config.common.grainRate.denominator;
         if (denom == 0) {
             denom = 1;
         }
-        audio_sample_rate = static_cast<uint32_t>(audio_flow_config.common.grainRate.numerator / denom);
-    }
-    if (audio_flow_config.continuous.channelCount > 0) {
-        audio_channel_count = audio_flow_config.continuous.channelCount;
+        audio_sample_rate = static_cast<uint32_t>(track.config.common.grainRate.numerator / denom);
     }
 
     return true;
 }
 
+mxl_audio_track *mxl_output_data::audio_track_for(size_t mix_idx)
+{
+    if (mix_idx >= MAX_AUDIO_MIXES || audio_track_for_mix[mix_idx] < 0) {
+        return nullptr;
+    }
+    return &audio_tracks[static_cast<size_t>(audio_track_for_mix[mix_idx])];
+}
+
+std::string mxl_derive_track_flow_id(const std::string &base_flow_id, size_t mix_idx)
+{
+    std::string id = base_flow_id;
+    if (id.size() < 2 || !isxdigit(static_cast<unsigned char>(id[id.size() - 1])) ||
+        !isxdigit(static_cast<unsigned char>(id[id.size() - 2]))) {
+        return id + "-" + std::to_string(mix_idx + 1);
+    }
+    unsigned last = static_cast<unsigned>(std::stoul(id.substr(id.size() - 2), nullptr, 16));
+    char hex[3];
+    snprintf(hex, sizeof(hex), "%02x", (last ^ static_cast<unsigned>(mix_idx + 1)) & 0xFF);
+    id.replace(id.size() - 2, 2, hex);
+    return id;
+}
+
 
 bool mxl_output_data::create_video_flow_descriptor()
 {
@@ -384,87 +688,300 @@ bool mxl_output_data::create_audio_flow_descriptor()
 }
 
 
+const char *mxl_video_conversion_name(mxl_video_conversion conversion)
+{
+    switch (conversion) {
+    case MXL_CONVERSION_NATIVE: return "native";
+    case MXL_CONVERSION_I422: return "i422";
+    case MXL_CONVERSION_P216: return "p216";
+    case MXL_CONVERSION_I210: return "i210";
+    default: return "auto";
+    }
+}
+
+mxl_video_conversion mxl_video_conversion_from_name(const char *name)
+{
+    if (!name) {
+        return MXL_CONVERSION_AUTO;
+    }
+    if (strcmp(name, "native") == 0) {
+        return MXL_CONVERSION_NATIVE;
+    }
+    if (strcmp(name, "i422") == 0) {
+        return MXL_CONVERSION_I422;
+    }
+    if (strcmp(name, "p216") == 0) {
+        return MXL_CONVERSION_P216;
+    }
+    if (strcmp(name, "i210") == 0) {
+        return MXL_CONVERSION_I210;
+    }
+    return MXL_CONVERSION_AUTO;
+}
+
+const char *mxl_video_packing_name(mxl_video_packing packing)
+{
+    return packing == MXL_PACKING_UYVY ? "uyvy" : "v210";
+}
+
+mxl_video_packing mxl_video_packing_from_name(const char *name)
+{
+    if (name && strcmp(name, "uyvy") == 0) {
+        return MXL_PACKING_UYVY;
+    }
+    return MXL_PACKING_V210;
+}
+
+const char *mxl_video_gap_policy_name(mxl_video_gap_policy policy)
+{
+    return policy == MXL_GAP_REPEAT ? "repeat" : "invalid";
+}
+
+mxl_video_gap_policy mxl_video_gap_policy_from_name(const char *name)
+{
+    if (name && strcmp(name, "repeat") == 0) {
+        return MXL_GAP_REPEAT;
+    }
+    return MXL_GAP_INVALID;
+}
+
+const char *mxl_audio_layout_name(mxl_audio_layout layout)
+{
+    return layout == MXL_AUDIO_LAYOUT_WIDE ? "wide" : "tracks";
+}
+
+mxl_audio_layout mxl_audio_layout_from_name(const char *name)
+{
+    if (name && strcmp(name, "wide") == 0) {
+        return MXL_AUDIO_LAYOUT_WIDE;
+    }
+    return MXL_AUDIO_LAYOUT_TRACKS;
+}
+
+bool mxl_output_data::choose_video_conversion(const struct obs_video_info &ovi,
+                                              struct video_scale_info &conversion) const
+{
+    enum video_format base = ovi.output_format;
+    enum video_format target = base;
+    // A profile with its own flow size has OBS scale the frames as well
+    bool scaled = video_width != ovi.output_width || video_height != ovi.output_height;
+
+    v210_source_format packable;
+    bool supported = to_v210_source_format(base, packable) &&
+                     (video_packing != MXL_PACKING_UYVY || uyvy_source_supported(packable));
+
+    switch (video_conversion) {
+    case MXL_CONVERSION_NATIVE:
+        if (!supported) {
+            // Same choice as AUTO: the nearest 4:2:2 format the packers read
+            blog(LOG_WARNING, "MXL Output: %s frames cannot be packed as they are, asking OBS to convert them",
+                 get_video_format_name(base));
+            target = base == VIDEO_FORMAT_P416 || base == VIDEO_FORMAT_I412 ? VIDEO_FORMAT_P216
+                                                                            : VIDEO_FORMAT_I422;
+            if (video_packing == MXL_PACKING_UYVY) {
+                target = VIDEO_FORMAT_I422;
+            }
+            break;
+        }
+        if (!scaled) {
+            return false;
+        }
+        conversion.format = base;
+        conversion.width = video_width;
+        conversion.height = video_height;
+        conversion.range = ovi.range;
+        conversion.colorspace = ovi.colorspace;
+        return true;
+    case MXL_CONVERSION_I422:
+        target = VIDEO_FORMAT_I422;
+        break;
+    case MXL_CONVERSION_P216:
+        target = VIDEO_FORMAT_P216;
+        break;
+    case MXL_CONVERSION_I210:
+        target = VIDEO_FORMAT_I210;
+        break;
+    default:
+        if (video_packing == MXL_PACKING_UYVY) {
+            // The UYVY packer only interleaves 8-bit YUV
+            if (base != VIDEO_FORMAT_NV12 && base != VIDEO_FORMAT_I420 && base != VIDEO_FORMAT_I422) {
+                target = VIDEO_FORMAT_I422;
+            }
+            break;
+        }
+        switch (base) {
+        // Packed as they are; asking for 4:2:2 would only move the chroma
+        // upsampling from our packer into libobs
+        case VIDEO_FORMAT_NV12:
+        case VIDEO_FORMAT_I420:
+        case VIDEO_FORMAT_I422:
+        case VIDEO_FORMAT_P010:
+        case VIDEO_FORMAT_I010:
+        case VIDEO_FORMAT_P216:
+        case VIDEO_FORMAT_I210:
+        case VIDEO_FORMAT_RGBA:
+        case VIDEO_FORMAT_BGRA:
+            break;
+        // 4:4:4 down to 4:2:2 at the same depth
+        case VIDEO_FORMAT_P416:
+        case VIDEO_FORMAT_I412:
+            target = VIDEO_FORMAT_P216;
+            break;
+        default:
+            target = VIDEO_FORMAT_I422;
+            break;
+        }
+        break;
+    }
+
+    if (video_packing == MXL_PACKING_UYVY && target != VIDEO_FORMAT_I422 &&
+        video_conversion != MXL_CONVERSION_AUTO) {
+        blog(LOG_WARNING, "MXL Output: Video conversion %s does not fit UYVY flows, requesting I422",
+             mxl_video_conversion_name(video_conversion));
+        target = VIDEO_FORMAT_I422;
+    }
+
+    // v210 flows are BT.709 limited range; YUV frames are packed without
+    // range or matrix conversion, so let OBS fix those up too
+    bool rgb = target == VIDEO_FORMAT_RGBA || target == VIDEO_FORMAT_BGRA;
+    bool range_ok = rgb || ovi.range != VIDEO_RANGE_FULL;
+    bool colorspace_ok = rgb || ovi.colorspace != VIDEO_CS_601;
+    if (target == base && range_ok && colorspace_ok && !scaled) {
+        return false;
+    }
+
+    conversion.format = target;
+    conversion.width = video_width;
+    conversion.height = video_height;
+    conversion.range = VIDEO_RANGE_PARTIAL;
+    conversion.colorspace = colorspace_ok ? ovi.colorspace : VIDEO_CS_709;
+    return true;
+}
+
+
 std::string mxl_output_data::get_mxl_video_media_type(enum video_format format)
 {
-    // MXL flows should use v210 format for video
-    return "video/v210";
+    // Flows carry v210 unless the user picked 8-bit UYVY (NMOS video/raw)
+    return video_packing == MXL_PACKING_UYVY ? "video/raw" : "video/v210";
 }
 
 
 
 size_t mxl_output_data::calculate_video_frame_size(enum video_format format, uint32_t width, uint32_t height)
 {
-    // For MXL output, we always convert to v210 format
+    // Independent of the OBS format: frames are packed to v210 or UYVY
     // v210: Each group of 6 pixels = 16 bytes (4 x 32-bit words)
-    uint32_t v210_stride = ((width + 5) / 6) * 16; // Round up to nearest 6-pixel group
-    v210_stride = (v210_stride + 3) & ~3; // Ensure 4-byte alignment
-    return v210_stride * height;
+    // UYVY: Each pair of pixels = 4 bytes
+    if (video_packing == MXL_PACKING_UYVY) {
+        return uyvy_line_bytes(width) * height;
+    }
+    return v210_line_bytes(width) * height;
 }
 
+size_t mxl_output_data::video_line_bytes(uint32_t width) const
+{
+    return video_packing == MXL_PACKING_UYVY ? uyvy_line_bytes(width) : v210_line_bytes(width);
+}
+
+
+std::string mxl_output_data::generate_video_descriptor_json(const std::string &flow_id, uint32_t width,
+                                                           uint32_t height, const std::string &label_prefix,
+                                                           const std::string &parent_id)
+{
+    std::stringstream ss;
+    std::string flow_label = label_prefix;
+    std::string flow_desc = label_prefix + " Flow";
+    if (height > 0 && video_fps_den > 0) {
+        flow_label = label_prefix + " " + std::to_string(height) + "p" +
+                     std::to_string(video_fps_num / video_fps_den);
+        flow_desc = flow_label;
+    }
+    std::string group_role = parent_id.empty() ? "video" : "video proxy";
+
+    ss << "{\n";
+    ss << "  \"description\": \"" << flow_desc << "\",\n";
+    ss << "  \"id\": \"" << flow_id << "\",\n";
+    ss << "  \"tags\": {\n";
+    ss << "     \"urn:x-nmos:tag:grouphint/v1.0\": [\"obs-output:" << group_role << "\"]\n";
+    ss << "  },\n";
+    ss << "  \"format\": \"urn:x-nmos:format:video\",\n";
+    ss << "  \"label\": \"" << flow_label << "\",\n";
+    if (parent_id.empty()) {
+        ss << "  \"parents\": [],\n";
+    } else {
+        ss << "  \"parents\": [\"" << parent_id << "\"],\n";
+    }
+    ss << "  \"media_type\": \"" << get_mxl_video_media_type(video_format) << "\",\n";
+    ss << "  \"grain_rate\": {\n";
+    ss << "    \"numerator\": " << video_fps_num << ",\n";
+    ss << "    \"denominator\": " << video_fps_den << "\n";
+    ss << "  },\n";
+    ss << "  \"frame_width\": " << width << ",\n";
+    ss << "  \"frame_height\": " << height << ",\n";
+    ss << "  \"interlace_mode\": \"progressive\",\n";
+    ss << "  \"colorspace\": \"BT709\",\n";
+    uint32_t bit_depth = video_packing == MXL_PACKING_UYVY ? 8 : 10;
+    ss << "  \"components\": [\n";
+    ss << "    {\n";
+    ss << "      \"name\": \"Y\",\n";
+    ss << "      \"width\": " << width << ",\n";
+    ss << "      \"height\": " << height << ",\n";
+    ss << "      \"bit_depth\": " << bit_depth << "\n";
+    ss << "    },\n";
+    ss << "    {\n";
+    ss << "      \"name\": \"Cb\",\n";
+    ss << "      \"width\": " << (width / 2) << ",\n";
+    ss << "      \"height\": " << height << ",\n";
+    ss << "      \"bit_depth\": " << bit_depth << "\n";
+    ss << "    },\n";
+    ss << "    {\n";
+    ss << "      \"name\": \"Cr\",\n";
+    ss << "      \"width\": " << (width / 2) << ",\n";
+    ss << "      \"height\": " << height << ",\n";
+    ss << "      \"bit_depth\": " << bit_depth << "\n";
+    ss << "    }\n";
+    ss << "  ]\n";
+    ss << "}";
+    return ss.str();
+}
 
-std::string mxl_output_data::generate_flow_descriptor_json(bool is_video)
+std::string mxl_output_data::generate_flow_descriptor_json(bool is_video, const mxl_audio_track *track)
 {
     std::stringstream ss;
 
     if (is_video) {
-        std::string flow_label = "MXL Video Output";
-        std::string flow_desc = "MXL Video Output Flow";
-        if (video_height > 0 && video_fps_den > 0) {
-            flow_label = "MXL Video Output " + std::to_string(video_height) + "p" +
-                         std::to_string(video_fps_num / video_fps_den);
-            flow_desc = flow_label;
-        }
-
-        ss << "{\n";
-        ss << "  \"description\": \"" << flow_desc << "\",\n";
-        ss << "  \"id\": \"" << video_flow_id << "\",\n";
-        ss << "  \"tags\": {\n";
-        ss << "     \"urn:x-nmos:tag:grouphint/v1.0\": [\"obs-output:video\"]\n";
-        ss << "  },\n";
-        ss << "  \"format\": \"urn:x-nmos:format:video\",\n";
-        ss << "  \"label\": \"" << flow_label << "\",\n";
-        ss << "  \"parents\": [],\n";
-        ss << "  \"media_type\": \"video/v210\",\n";
-        ss << "  \"grain_rate\": {\n";
-        ss << "    \"numerator\": " << video_fps_num << ",\n";
-        ss << "    \"denominator\": " << video_fps_den << "\n";
-        ss << "  },\n";
-        ss << "  \"frame_width\": " << video_width << ",\n";
-        ss << "  \"frame_height\": " << video_height << ",\n";
-        ss << "  \"interlace_mode\": \"progressive\",\n";
-        ss << "  \"colorspace\": \"BT709\",\n";
-        ss << "  \"components\": [\n";
-        ss << "    {\n";
-        ss << "      \"name\": \"Y\",\n";
-        ss << "      \"width\": " << video_width << ",\n";
-        ss << "      \"height\": " << video_height << ",\n";
-        ss << "      \"bit_depth\": 10\n";
-        ss << "    },\n";
-        ss << "    {\n";
-        ss << "      \"name\": \"Cb\",\n";
-        ss << "      \"width\": " << (video_width / 2) << ",\n";
-        ss << "      \"height\": " << video_height << ",\n";
-        ss << "      \"bit_depth\": 10\n";
-        ss << "    },\n";
-        ss << "    {\n";
-        ss << "      \"name\": \"Cr\",\n";
-        ss << "      \"width\": " << (video_width / 2) << ",\n";
-        ss << "      \"height\": " << video_height << ",\n";
-        ss << "      \"bit_depth\": 10\n";
-        ss << "    }\n";
-        ss << "  ]\n";
-        ss << "}";
+        return generate_video_descriptor_json(video_flow_id, video_width, video_height, "MXL Video Output", "");
     } else {
         uint32_t sample_rate = audio_sample_rate > 0 ? audio_sample_rate : 48000;
         uint32_t channels = audio_channel_count > 0 ? audio_channel_count : 2;
+        if (track && track->channel_count > 0) {
+            channels = track->channel_count;
+        }
+        std::string flow_id = track ? track->flow_id : audio_flow_id;
         std::string flow_label = "MXL Audio Output";
         std::string flow_desc = "MXL Audio Output Flow";
+        std::string group_role = "audio";
+        // With several tracks every flow is named after its OBS track
+        if (track && track->wide_mixers) {
+            std::string track_names;
+            for (size_t mix = 0; mix < MAX_AUDIO_MIXES; mix++) {
+                if (track->wide_mixers & (1u << mix)) {
+                    track_names += (track_names.empty() ? "" : "+") + std::to_string(mix + 1);
+                }
+            }
+            flow_desc += " (Tracks " + track_names + ")";
+        } else if (track && audio_tracks.size() > 1) {
+            std::string track_name = "Track " + std::to_string(track->mix_idx + 1);
+            flow_label += " " + track_name;
+            flow_desc += " (" + track_name + ")";
+            group_role = "audio " + track_name;
+        }
 
         ss << "{\n";
         ss << "  \"description\": \"" << flow_desc << "\",\n";
-        ss << "  \"id\": \"" << audio_flow_id << "\",\n";
+        ss << "  \"id\": \"" << flow_id << "\",\n";
         ss << "  \"tags\": {\n";
-        ss << "     \"urn:x-nmos:tag:grouphint/v1.0\": [\"obs-output:audio\"]\n";
+        ss << "     \"urn:x-nmos:tag:grouphint/v1.0\": [\"obs-output:" << group_role << "\"]\n";
         ss << "  },\n";
         ss << "  \"format\": \"urn:x-nmos:format:audio\",\n";
         ss << "  \"label\": \"" << flow_label << "\",\n";
@@ -487,40 +1004,33 @@ void mxl_output_data::output_loop()
     blog(LOG_INFO, "MXL Output: Output thread started");
     
     while (thread_active) {
-        std::unique_lock<std::mutex> lock(video_queue_mutex);
-        
-        // Wait for frames or thread termination with timeout
-        frame_condition.wait_for(lock, std::chrono::milliseconds(100), [this] {
-            return !thread_active || !video_queue.empty();
-        });
+        {
+            std::unique_lock<std::mutex> lock(video_queue_mutex);
+            
+            // Wait for frames or thread termination with timeout
+            frame_condition.wait_for(lock, std::chrono::milliseconds(100), [this] {
+                return !thread_active || !video_queue.empty();
+            });
+        }
         
         if (!thread_active) {
             break;
         }
         
-        // Process video frames
-        while (!video_queue.empty()) {
-            auto frame = std::move(video_queue.front());
-            video_queue.pop();
-            lock.unlock();
-            
+        // Process video frames; the ring itself needs no lock
+        while (video_frame_ptr frame = video_queue.pop()) {
             if (!process_video_frame(std::move(frame))) {
+                dropped_video_frames.fetch_add(1);
                 blog(LOG_WARNING, "MXL Output: Failed to process video frame");
             }
-            
-            lock.lock();
         }
     }
     
     blog(LOG_INFO, "MXL Output: Output thread stopped");
 }
 
-bool mxl_output_data::process_video_frame(std::unique_ptr<video_frame_data> frame)
+uint64_t mxl_output_data::next_video_grain_index(uint64_t timestamp)
 {
-    if (!video_flow_writer || !frame) {
-        return false;
-    }
-    
     mxlRational frame_rate = flow_config.common.grainRate;
     if (frame_rate.numerator == 0) {
         frame_rate = {static_cast<int32_t>(video_fps_num), static_cast<int32_t>(video_fps_den)};
@@ -529,13 +1039,8 @@ bool mxl_output_data::process_video_frame(std::unique_ptr<video_frame_data> fram
     uint64_t current_index = mxlGetCurrentIndex(&frame_rate);
     uint64_t grain_index = current_index;
 
-    if (frame->timestamp > 0) {
-        if (!has_time_offset) {
-            mxl_time_offset_ns = static_cast<int64_t>(mxlGetTime()) - static_cast<int64_t>(frame->timestamp);
-            has_time_offset = true;
-        }
-        uint64_t mxl_ts = static_cast<uint64_t>(static_cast<int64_t>(frame->timestamp) + mxl_time_offset_ns);
-        grain_index = mxlTimestampToIndex(&frame_rate, mxl_ts);
+    if (timestamp > 0) {
+        grain_index = mxlTimestampToIndex(&frame_rate, to_mxl_time(timestamp));
 
         uint32_t grain_count = flow_config.discrete.grainCount;
         if (grain_count > 0 && grain_index > current_index && (grain_index - current_index) > grain_count) {
@@ -547,72 +1052,376 @@ bool mxl_output_data::process_video_frame(std::unique_ptr<video_frame_data> fram
         if (grain_index <= last_grain_index) {
             grain_index = last_grain_index + 1;
         } else if (grain_index > last_grain_index + 1) {
-            for (uint64_t idx = last_grain_index + 1; idx < grain_index; ++idx) {
+            // Only the grains that stay in the ring next to the new one are
+            // worth marking; older ones are gone before a reader can ask, so
+            // a long stall costs at most grainCount - 1 fills
+            uint64_t first_missing = last_grain_index + 1;
+            uint32_t grain_count = flow_config.discrete.grainCount;
+            if (grain_count > 0 && grain_index - first_missing > grain_count - 1) {
+                uint64_t skipped = grain_index - (grain_count - 1) - first_missing;
+                blog(LOG_WARNING, "MXL Output: Video stalled for %" PRIu64 " grains, skipping %" PRIu64
+                     " past the flow history", grain_index - first_missing, skipped);
+                first_missing += skipped;
+            }
+            // MXL_GAP_REPEAT fetches the last good grain once and copies it
+            // into every missed grain still in the history, so a reader that
+            // kept up sees a frozen frame from first_missing on; a grain
+            // becomes invalid only when there is nothing to repeat
+            bool repeat = video_gap_policy == MXL_GAP_REPEAT &&
+                          fetch_repeat_source(repeat_video, last_grain_index, grain_count, first_missing,
+                                              grain_index - 1);
+            if (repeat) {
+                fetch_repeat_source(repeat_proxy, last_grain_index, proxy_flow_config.discrete.grainCount,
+                                    first_missing, grain_index - 1);
+            }
+            for (uint64_t idx = first_missing; idx < grain_index; ++idx) {
+                if (repeat && write_repeat_grain(idx)) {
+                    continue;
+                }
                 if (!write_invalid_grain(idx)) {
                     blog(LOG_WARNING, "MXL Output: Failed to write invalid grain %" PRIu64, idx);
                     break;
                 }
             }
+            repeat_video.payload = nullptr;
+            repeat_proxy.payload = nullptr;
         }
     }
     
     // Log grain writing occasionally to avoid spam
-    static uint64_t last_logged_video_grain = 0;
     if (grain_index % 100 == 0 && grain_index != last_logged_video_grain) {
-        blog(LOG_DEBUG, "MXL Output: Writing video grain %" PRIu64 " (rate: %lld/%lld)",
-             grain_index, (long long)frame_rate.numerator, (long long)frame_rate.denominator);
+        blog(LOG_DEBUG, "MXL Output: Writing video grain %" PRIu64 " (rate: %lld/%lld, clock drift: %lld ns)",
+             grain_index, (long long)frame_rate.numerator, (long long)frame_rate.denominator,
+             (long long)mxl_clock.drift());
         last_logged_video_grain = grain_index;
     }
+
+    return grain_index;
+}
+
+void mxl_output_data::sample_mxl_clock()
+{
+    uint64_t before = os_gettime_ns();
+    uint64_t mxl_now = mxlGetTime();
+    uint64_t after = os_gettime_ns();
+    if (after - before > MXL_CLOCK_READ_WINDOW_NS) {
+        return;
+    }
+    if (mxl_clock.update(before + (after - before) / 2, mxl_now)) {
+        blog(LOG_WARNING, "MXL Output: MXL time stepped against the OBS clock, drift now %lld ns",
+             (long long)mxl_clock.drift());
+    }
+}
+
+void mxl_output_data::reset_time_base()
+{
+    mxl_clock.reset();
+    // Retry preempted readings so the base starts from a clean pair
+    for (int attempt = 0; attempt < 8 && !mxl_clock.valid(); attempt++) {
+        sample_mxl_clock();
+    }
+}
+
+uint64_t mxl_output_data::to_mxl_time(uint64_t timestamp)
+{
+    sample_mxl_clock();
+    int64_t offset = mxl_clock.valid() ? mxl_clock.offset()
+                                       : static_cast<int64_t>(mxlGetTime()) - static_cast<int64_t>(os_gettime_ns());
+    return static_cast<uint64_t>(static_cast<int64_t>(timestamp) + offset);
+}
+
+bool mxl_output_data::commit_video_grain(uint64_t grain_index, mxlGrainInfo &grain_info)
+{
+    mxlStatus status = mxlFlowWriterCommitGrain(video_flow_writer, &grain_info);
+    if (status != MXL_STATUS_OK) {
+        blog(LOG_ERROR, "MXL Output: Failed to commit video grain %" PRIu64 " (status: %d)", grain_index, status);
+        mxlFlowWriterCancelGrain(video_flow_writer);
+        return false;
+    }
+    
+    // Update our counter for statistics
+    video_grain_index.fetch_add(1);
+    last_grain_index = grain_index;
+    last_grain_index_valid = true;
+    
+    return true;
+}
+
+bool mxl_output_data::process_video_frame(video_frame_ptr frame)
+{
+    if (!video_flow_writer || !frame) {
+        return false;
+    }
+    
+    mxl_profile_scope scope(PROFILE_PROCESS_VIDEO_FRAME);
+    
+    return write_video_grain(frame->planes.data, frame->planes.linesize, frame->timestamp);
+}
+
+bool mxl_output_data::write_video_frame_direct(struct video_data *frame)
+{
+    if (!video_flow_writer || !frame) {
+        return false;
+    }
+    
+    mxl_profile_scope scope(PROFILE_WRITE_VIDEO_DIRECT);
+    
+    return write_video_grain(frame->data, frame->linesize, frame->timestamp);
+}
+
+bool mxl_output_data::write_video_grain(uint8_t **planes, uint32_t *linesize, uint64_t timestamp)
+{
+    if (video_height == 0) {
+        return false;
+    }
+    
+    uint64_t grain_index = next_video_grain_index(timestamp);
     
     mxlGrainInfo grain_info = {};
     uint8_t* payload = nullptr;
-    
-    // Open grain for writing
     mxlStatus status = mxlFlowWriterOpenGrain(video_flow_writer, grain_index, &grain_info, &payload);
     if (status != MXL_STATUS_OK) {
         blog(LOG_ERROR, "MXL Output: Failed to open video grain %" PRIu64 " (status: %d)", grain_index, status);
         return false;
     }
     
-    // Set grain info
+    // Convert straight into the grain using its own line stride; grain lines
+    // may be padded beyond the packed line (e.g. to 128 bytes)
+    size_t dst_stride = grain_info.grainSize / video_height;
+    if (!payload || dst_stride < video_line_bytes()) {
+        blog(LOG_ERROR, "MXL Output: Video grain %" PRIu64 " cannot hold a frame (grain size: %u)",
+             grain_index, grain_info.grainSize);
+        mxlFlowWriterCancelGrain(video_flow_writer);
+        return false;
+    }
+    
+    // The proxy is packed by the same band jobs; without an open proxy grain
+    // only the main flow is written
+    mxlGrainInfo proxy_info = {};
+    open_proxy_grain(grain_index, proxy_info);
+    
+    // Pack and commit in row batches so slice-aware readers can start on the
+    // top of the frame while the bottom is still being packed. Batch edges
+    // fall on even rows, like band edges, so 4:2:0 chroma lines and proxy
+    // row pairs are never split.
     grain_info.flags = 0;
+    uint32_t row_pairs = (video_height + 1) / 2;
+    uint32_t batches = std::min(std::max(video_slice_batches, 1u), row_pairs);
+    for (uint32_t batch = 0; batch < batches; batch++) {
+        uint32_t row_begin = std::min(video_height,
+            static_cast<uint32_t>(2 * (static_cast<uint64_t>(row_pairs) * batch / batches)));
+        uint32_t row_end = std::min(video_height,
+            static_cast<uint32_t>(2 * (static_cast<uint64_t>(row_pairs) * (batch + 1) / batches)));
+        bool converted;
+        if (video_packing == MXL_PACKING_UYVY) {
+            converted = convert_to_uyvy(planes, linesize, video_format, video_width, video_height,
+                                        payload, grain_info.grainSize, dst_stride, row_begin, row_end);
+        } else {
+            converted = convert_to_v210(planes[0], video_format, video_width, video_height, linesize,
+                                        payload, grain_info.grainSize, planes, dst_stride, row_begin, row_end);
+        }
+        if (!converted) {
+            blog(LOG_ERROR, "MXL Output: Failed to convert video frame into grain %" PRIu64 " (grain size: %u)",
+                 grain_index, grain_info.grainSize);
+            mxlFlowWriterCancelGrain(video_flow_writer);
+            close_proxy_grain(grain_index, proxy_info, false);
+            return false;
+        }
+        if (row_end == video_height) {
+            break;
+        }
+        
+        grain_info.validSlices = static_cast<uint16_t>(
+            static_cast<uint64_t>(grain_info.totalSlices) * row_end / video_height);
+        status = mxlFlowWriterCommitGrain(video_flow_writer, &grain_info);
+        if (status != MXL_STATUS_OK) {
+            blog(LOG_ERROR, "MXL Output: Failed to commit %u slices of video grain %" PRIu64 " (status: %d)",
+                 grain_info.validSlices, grain_index, status);
+            mxlFlowWriterCancelGrain(video_flow_writer);
+            close_proxy_grain(grain_index, proxy_info, false);
+            return false;
+        }
+    }
     
-    // Copy frame data to MXL payload
-    if (payload && frame->data && frame->size > 0) {
-        size_t copy_size = std::min(frame->size, static_cast<size_t>(grain_info.grainSize));
-        memcpy(payload, frame->data, copy_size);
-	//grain_info.commitedSize = copy_size;
-        grain_info.validSlices = grain_info.totalSlices;
+    grain_info.validSlices = grain_info.totalSlices;
+    bool committed = commit_video_grain(grain_index, grain_info);
+    close_proxy_grain(grain_index, proxy_info, committed);
+    return committed;
+}
 
-        blog(LOG_DEBUG, "MXL Output: Copied %zu bytes to video grain %" PRIu64 " (grain size: %u)", 
-             copy_size, grain_index, grain_info.grainSize);
+bool mxl_output_data::open_proxy_grain(uint64_t grain_index, mxlGrainInfo &grain_info)
+{
+    proxy_payload = nullptr;
+    if (!proxy_flow_writer || proxy_frame.height == 0) {
+        return false;
     }
     
-    // Commit the grain
-    status = mxlFlowWriterCommitGrain(video_flow_writer, &grain_info);
+    uint8_t *payload = nullptr;
+    mxlStatus status = mxlFlowWriterOpenGrain(proxy_flow_writer, grain_index, &grain_info, &payload);
     if (status != MXL_STATUS_OK) {
-        blog(LOG_ERROR, "MXL Output: Failed to commit video grain %" PRIu64 " (status: %d)", grain_index, status);
-        mxlFlowWriterCancelGrain(video_flow_writer);
+        blog(LOG_WARNING, "MXL Output: Failed to open proxy grain %" PRIu64 " (status: %d)", grain_index, status);
+        return false;
+    }
+    size_t stride = grain_info.grainSize / proxy_height;
+    if (!payload || stride < video_line_bytes(proxy_width)) {
+        mxlFlowWriterCancelGrain(proxy_flow_writer);
         return false;
     }
     
-    // Update our counter for statistics
-    video_grain_index.fetch_add(1);
-    last_grain_index = grain_index;
-    last_grain_index_valid = true;
+    // Every packed group is rewritten per frame; only the padding needs clearing
+    if (video_packing == MXL_PACKING_UYVY) {
+        uyvy_clear_padding(payload, stride, proxy_width, proxy_height, grain_info.grainSize);
+    } else {
+        v210_clear_padding(payload, stride, proxy_width, proxy_height, grain_info.grainSize);
+    }
+    grain_info.flags = 0;
+    proxy_payload = payload;
+    proxy_stride = stride;
+    return true;
+}
+
+void mxl_output_data::close_proxy_grain(uint64_t grain_index, mxlGrainInfo &grain_info, bool commit)
+{
+    if (!proxy_payload) {
+        return;
+    }
+    proxy_payload = nullptr;
     
+    if (!commit) {
+        mxlFlowWriterCancelGrain(proxy_flow_writer);
+        return;
+    }
+    grain_info.validSlices = grain_info.totalSlices;
+    mxlStatus status = mxlFlowWriterCommitGrain(proxy_flow_writer, &grain_info);
+    if (status != MXL_STATUS_OK) {
+        blog(LOG_WARNING, "MXL Output: Failed to commit proxy grain %" PRIu64 " (status: %d)", grain_index, status);
+        mxlFlowWriterCancelGrain(proxy_flow_writer);
+    }
+}
+
+bool mxl_output_data::write_audio_samples(mxl_audio_track &track, struct audio_data *frames)
+{
+    if (!track.writer || !frames || frames->frames == 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(audio_mutex);
+    mxl_profile_scope scope(PROFILE_WRITE_AUDIO_SAMPLES);
+
+    uint64_t start_index = audio_start_index(track, frames);
+    uint64_t count = frames->frames;
+
+    mxlMutableWrappedMultiBufferSlice payload = {};
+    mxlStatus status = mxlFlowWriterOpenSamples(track.writer, start_index, count, &payload);
+    if (status != MXL_STATUS_OK) {
+        blog(LOG_ERROR, "MXL Output: Failed to open audio samples at %" PRIu64 " (status: %d)", start_index, status);
+        return false;
+    }
+
+    const float *planes[MAX_AV_PLANES] = {};
+    size_t src_channels = MAX_AV_PLANES;
+    if (track.channel_count > 0 && track.channel_count < src_channels) {
+        src_channels = track.channel_count;
+    }
+    for (size_t ch = 0; ch < src_channels; ++ch) {
+        planes[ch] = reinterpret_cast<const float*>(frames->data[ch]);
+    }
+    mxl_audio_write_planar(to_audio_slice(payload), planes, src_channels);
+
+    status = mxlFlowWriterCommitSamples(track.writer);
+    if (status != MXL_STATUS_OK) {
+        blog(LOG_ERROR, "MXL Output: Failed to commit audio samples at %" PRIu64 " (status: %d)", start_index, status);
+        mxlFlowWriterCancelSamples(track.writer);
+        return false;
+    }
+
+    track.last_index_end = start_index + count;
+    track.last_index_valid = true;
     return true;
 }
 
-bool mxl_output_data::write_audio_samples(struct audio_data *frames)
+bool mxl_output_data::write_wide_audio_samples(mxl_audio_track &track, size_t mix_idx, struct audio_data *frames)
 {
-    if (!audio_flow_writer || !frames || frames->frames == 0) {
+    uint32_t mixer_bit = 1u << mix_idx;
+    if (!track.writer || !frames || frames->frames == 0 || !(track.wide_mixers & mixer_bit)) {
         return false;
     }
 
     std::lock_guard<std::mutex> lock(audio_mutex);
+    mxl_profile_scope scope(PROFILE_WRITE_AUDIO_SAMPLES);
+
+    // OBS hands out the mixers of one audio block back to back with the same
+    // timestamp. A repeat or a new block means some mixer skipped the open one.
+    if (track.wide_open && (!(track.wide_pending & mixer_bit) || frames->timestamp != track.wide_timestamp ||
+                            frames->frames != track.wide_frames)) {
+        commit_wide_samples(track);
+    }
+
+    if (!track.wide_open) {
+        uint64_t start_index = audio_start_index(track, frames);
+        track.wide_payload = {};
+        mxlStatus status = mxlFlowWriterOpenSamples(track.writer, start_index, frames->frames, &track.wide_payload);
+        if (status != MXL_STATUS_OK) {
+            blog(LOG_ERROR, "MXL Output: Failed to open audio samples at %" PRIu64 " (status: %d)", start_index, status);
+            return false;
+        }
+        track.wide_open = true;
+        track.wide_pending = track.wide_mixers;
+        track.wide_timestamp = frames->timestamp;
+        track.wide_start = start_index;
+        track.wide_frames = frames->frames;
+    }
 
-    mxlRational sample_rate = audio_flow_config.common.grainRate;
+    const float *planes[MAX_AV_PLANES] = {};
+    size_t src_channels = std::min<size_t>(track.channels_per_mixer, MAX_AV_PLANES);
+    for (size_t ch = 0; ch < src_channels; ++ch) {
+        planes[ch] = reinterpret_cast<const float*>(frames->data[ch]);
+    }
+    size_t first_channel = std::bitset<32>(track.wide_mixers & (mixer_bit - 1)).count() * track.channels_per_mixer;
+    mxl_audio_write_channels(to_audio_slice(track.wide_payload), first_channel, planes, src_channels);
+
+    track.wide_pending &= ~mixer_bit;
+    if (track.wide_pending == 0) {
+        return commit_wide_samples(track);
+    }
+    return true;
+}
+
+bool mxl_output_data::commit_wide_samples(mxl_audio_track &track)
+{
+    if (!track.wide_open) {
+        return true;
+    }
+    track.wide_open = false;
+
+    // Mixers that never delivered this block leave silence in their channels
+    mxl_audio_mutable_slice slice = to_audio_slice(track.wide_payload);
+    for (size_t mix = 0; mix < MAX_AUDIO_MIXES; mix++) {
+        uint32_t mixer_bit = 1u << mix;
+        if (track.wide_pending & mixer_bit) {
+            size_t first_channel = std::bitset<32>(track.wide_mixers & (mixer_bit - 1)).count() *
+                                   track.channels_per_mixer;
+            mxl_audio_write_channels(slice, first_channel, nullptr, track.channels_per_mixer);
+        }
+    }
+    track.wide_pending = 0;
+
+    mxlStatus status = mxlFlowWriterCommitSamples(track.writer);
+    if (status != MXL_STATUS_OK) {
+        blog(LOG_ERROR, "MXL Output: Failed to commit audio samples at %" PRIu64 " (status: %d)",
+             track.wide_start, status);
+        mxlFlowWriterCancelSamples(track.writer);
+        return false;
+    }
+
+    track.last_index_end = track.wide_start + track.wide_frames;
+    track.last_index_valid = true;
+    return true;
+}
+
+uint64_t mxl_output_data::audio_start_index(mxl_audio_track &track, const struct audio_data *frames)
+{
+    mxlRational sample_rate = track.config.common.grainRate;
     if (sample_rate.numerator == 0) {
         sample_rate = {static_cast<int32_t>(audio_sample_rate), 1};
     }
@@ -621,130 +1430,210 @@ bool mxl_output_data::write_audio_samples(struct audio_data *frames)
     uint64_t start_index = current_index;
 
     if (frames->timestamp > 0) {
-        if (!audio_has_time_offset) {
-            audio_time_offset_ns = static_cast<int64_t>(mxlGetTime()) - static_cast<int64_t>(frames->timestamp);
-            audio_has_time_offset = true;
-        }
-        uint64_t mxl_ts = static_cast<uint64_t>(static_cast<int64_t>(frames->timestamp) + audio_time_offset_ns);
-        start_index = mxlTimestampToIndex(&sample_rate, mxl_ts);
+        start_index = mxlTimestampToIndex(&sample_rate, to_mxl_time(frames->timestamp));
 
-        uint32_t buffer_length = audio_flow_config.continuous.bufferLength;
+        uint32_t buffer_length = track.config.continuous.bufferLength;
         if (buffer_length > 0 && start_index > current_index &&
             (start_index - current_index) > buffer_length) {
             start_index = current_index + buffer_length - 1;
         }
     }
 
-    uint64_t count = frames->frames;
-    if (last_audio_index_valid) {
-        if (start_index < last_audio_index_end) {
-            start_index = last_audio_index_end;
-        } else if (start_index > last_audio_index_end) {
-            uint64_t gap = start_index - last_audio_index_end;
-            if (!write_silence_samples(last_audio_index_end, gap)) {
-                blog(LOG_WARNING, "MXL Output: Failed to write silence for gap (%" PRIu64 " samples)", gap);
+    if (track.last_index_valid) {
+        if (start_index < track.last_index_end) {
+            start_index = track.last_index_end;
+        } else if (start_index > track.last_index_end) {
+            // Silence only where the ring still holds it next to the new
+            // block; the write position moves straight past anything older
+            uint64_t gap = start_index - track.last_index_end;
+            uint64_t fill = gap;
+            uint32_t buffer_length = track.config.continuous.bufferLength;
+            if (buffer_length > 0) {
+                fill = std::min<uint64_t>(gap, buffer_length > frames->frames ? buffer_length - frames->frames : 0);
+            }
+            if (fill < gap) {
+                blog(LOG_WARNING, "MXL Output: Audio stalled for %" PRIu64 " samples, skipping %" PRIu64
+                     " past the flow history", gap, gap - fill);
+            }
+            if (fill > 0 && !write_silence_samples(track, start_index - fill, fill)) {
+                blog(LOG_WARNING, "MXL Output: Failed to write silence for gap (%" PRIu64 " samples)", fill);
             }
         }
     }
+    return start_index;
+}
 
-    mxlMutableWrappedMultiBufferSlice payload = {};
-    mxlStatus status = mxlFlowWriterOpenSamples(audio_flow_writer, start_index, count, &payload);
-    if (status != MXL_STATUS_OK) {
-        blog(LOG_ERROR, "MXL Output: Failed to open audio samples at %" PRIu64 " (status: %d)", start_index, status);
+bool mxl_output_data::write_silence_samples(mxl_audio_track &track, uint64_t start_index, uint64_t count)
+{
+    if (!track.writer || count == 0) {
         return false;
     }
 
-    size_t channels = payload.count;
-    size_t offset_samples = 0;
-    for (int frag = 0; frag < 2; ++frag) {
-        auto &fragment = payload.base.fragments[frag];
-        if (!fragment.pointer || fragment.size == 0) {
-            continue;
+    // One open/commit per half ring, so a capped gap takes at most two
+    uint64_t batch = track.config.continuous.bufferLength / 2;
+    if (batch == 0) {
+        batch = count;
+    }
+    for (uint64_t done = 0; done < count;) {
+        uint64_t batch_count = std::min(batch, count - done);
+        mxlMutableWrappedMultiBufferSlice payload = {};
+        mxlStatus status = mxlFlowWriterOpenSamples(track.writer, start_index + done, batch_count, &payload);
+        if (status != MXL_STATUS_OK) {
+            return false;
         }
-        size_t fragment_samples = fragment.size / sizeof(float);
-        for (size_t ch = 0; ch < channels; ++ch) {
-            uint8_t *dst = static_cast<uint8_t*>(fragment.pointer) + ch * payload.stride;
-            float *src = nullptr;
-            if (audio_channel_count == 0 || ch < audio_channel_count) {
-                src = frames->data[ch] ? reinterpret_cast<float*>(frames->data[ch]) + offset_samples : nullptr;
-            }
-            if (src) {
-                memcpy(dst, src, fragment_samples * sizeof(float));
-            } else {
-                memset(dst, 0, fragment_samples * sizeof(float));
-            }
+
+        mxl_audio_write_silence(to_audio_slice(payload));
+
+        status = mxlFlowWriterCommitSamples(track.writer);
+        if (status != MXL_STATUS_OK) {
+            mxlFlowWriterCancelSamples(track.writer);
+            return false;
         }
-        offset_samples += fragment_samples;
-    }
 
-    status = mxlFlowWriterCommitSamples(audio_flow_writer);
-    if (status != MXL_STATUS_OK) {
-        blog(LOG_ERROR, "MXL Output: Failed to commit audio samples at %" PRIu64 " (status: %d)", start_index, status);
-        mxlFlowWriterCancelSamples(audio_flow_writer);
-        return false;
+        done += batch_count;
+        track.last_index_end = start_index + done;
+        track.last_index_valid = true;
     }
-
-    last_audio_index_end = start_index + count;
-    last_audio_index_valid = true;
     return true;
 }
 
-bool mxl_output_data::write_silence_samples(uint64_t start_index, uint64_t count)
+bool mxl_output_data::write_invalid_grain(uint64_t grain_index)
 {
-    if (!audio_flow_writer || count == 0) {
+    mxlGrainInfo grain_info = {};
+    uint8_t* payload = nullptr;
+
+    mxlStatus status = mxlFlowWriterOpenGrain(video_flow_writer, grain_index, &grain_info, &payload);
+    if (status != MXL_STATUS_OK) {
         return false;
     }
 
-    mxlMutableWrappedMultiBufferSlice payload = {};
-    mxlStatus status = mxlFlowWriterOpenSamples(audio_flow_writer, start_index, count, &payload);
+    grain_info.flags = MXL_GRAIN_FLAG_INVALID;
+    grain_info.validSlices = 0;
+
+    status = mxlFlowWriterCommitGrain(video_flow_writer, &grain_info);
     if (status != MXL_STATUS_OK) {
+        mxlFlowWriterCancelGrain(video_flow_writer);
         return false;
     }
 
-    for (int frag = 0; frag < 2; ++frag) {
-        auto &fragment = payload.base.fragments[frag];
-        if (!fragment.pointer || fragment.size == 0) {
-            continue;
-        }
-        for (size_t ch = 0; ch < payload.count; ++ch) {
-            uint8_t *dst = static_cast<uint8_t*>(fragment.pointer) + ch * payload.stride;
-            memset(dst, 0, fragment.size);
-        }
-    }
+    write_proxy_gap_grain(grain_index, false);
+    return true;
+}
 
-    status = mxlFlowWriterCommitSamples(audio_flow_writer);
+bool mxl_output_data::open_repeat_source(mxl_repeat_source &source, const std::string &flow_id)
+{
+    close_repeat_source(source);
+    mxlStatus status = mxlCreateFlowReader(mxl_instance, flow_id.c_str(), "", &source.reader);
     if (status != MXL_STATUS_OK) {
-        mxlFlowWriterCancelSamples(audio_flow_writer);
+        blog(LOG_WARNING, "MXL Output: Failed to create repeat reader for flow %s (status: %d); gaps stay invalid",
+             flow_id.c_str(), status);
+        source.reader = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void mxl_output_data::close_repeat_source(mxl_repeat_source &source)
+{
+    if (source.reader) {
+        mxlReleaseFlowReader(mxl_instance, source.reader);
+        source.reader = nullptr;
+    }
+    source.payload = nullptr;
+    source.size = 0;
+    source.staging.clear();
+    source.staging.shrink_to_fit();
+}
+
+bool mxl_output_data::fetch_repeat_source(mxl_repeat_source &source, uint64_t index, uint32_t grain_count,
+                                          uint64_t fill_begin, uint64_t fill_end)
+{
+    source.payload = nullptr;
+    if (!source.reader) {
         return false;
     }
 
-    last_audio_index_end = start_index + count;
-    last_audio_index_valid = true;
+    // The grain was committed by this writer, so it is there without waiting
+    mxlGrainInfo grain_info = {};
+    uint8_t *payload = nullptr;
+    mxlStatus status = mxlFlowReaderGetGrain(source.reader, index, 0, &grain_info, &payload);
+    if (status != MXL_STATUS_OK || !payload || (grain_info.flags & MXL_GRAIN_FLAG_INVALID) ||
+        grain_info.validSlices != grain_info.totalSlices) {
+        return false;
+    }
+    source.payload = payload;
+    source.size = grain_info.grainSize;
+
+    // After a stall as long as the ring, one of the repeats lands in the
+    // grain's own slot; copy it out first in that case only
+    if (grain_count > 0) {
+        uint64_t slot = index % grain_count;
+        uint64_t first_reuse = fill_begin + (slot + grain_count - fill_begin % grain_count) % grain_count;
+        if (first_reuse <= fill_end) {
+            source.staging.assign(payload, payload + source.size);
+            source.payload = source.staging.data();
+        }
+    }
     return true;
 }
 
-bool mxl_output_data::write_invalid_grain(uint64_t grain_index)
+bool mxl_output_data::write_repeat_grain(uint64_t grain_index)
 {
+    if (!repeat_video.payload) {
+        return false;
+    }
+
     mxlGrainInfo grain_info = {};
     uint8_t* payload = nullptr;
-
     mxlStatus status = mxlFlowWriterOpenGrain(video_flow_writer, grain_index, &grain_info, &payload);
     if (status != MXL_STATUS_OK) {
         return false;
     }
+    if (!payload || grain_info.grainSize != repeat_video.size) {
+        mxlFlowWriterCancelGrain(video_flow_writer);
+        return false;
+    }
 
-    grain_info.flags = MXL_GRAIN_FLAG_INVALID;
-    grain_info.validSlices = 0;
-
+    memcpy(payload, repeat_video.payload, repeat_video.size);
+    grain_info.flags = 0;
+    grain_info.validSlices = grain_info.totalSlices;
     status = mxlFlowWriterCommitGrain(video_flow_writer, &grain_info);
     if (status != MXL_STATUS_OK) {
         mxlFlowWriterCancelGrain(video_flow_writer);
         return false;
     }
 
+    repeated_video_grains.fetch_add(1);
+    write_proxy_gap_grain(grain_index, true);
     return true;
 }
 
+void mxl_output_data::write_proxy_gap_grain(uint64_t grain_index, bool repeat)
+{
+    if (!proxy_flow_writer) {
+        return;
+    }
+
+    // Follows the main grain: a repeat of the fetched proxy payload when there
+    // is one, an invalid grain otherwise
+    mxlGrainInfo grain_info = {};
+    uint8_t *payload = nullptr;
+    if (mxlFlowWriterOpenGrain(proxy_flow_writer, grain_index, &grain_info, &payload) != MXL_STATUS_OK) {
+        return;
+    }
+    if (repeat && payload && repeat_proxy.payload && grain_info.grainSize == repeat_proxy.size) {
+        memcpy(payload, repeat_proxy.payload, repeat_proxy.size);
+        grain_info.flags = 0;
+        grain_info.validSlices = grain_info.totalSlices;
+    } else {
+        grain_info.flags = MXL_GRAIN_FLAG_INVALID;
+        grain_info.validSlices = 0;
+    }
+    if (mxlFlowWriterCommitGrain(proxy_flow_writer, &grain_info) != MXL_STATUS_OK) {
+        mxlFlowWriterCancelGrain(proxy_flow_writer);
+    }
+}
+
 
 
 uint64_t mxl_output_data::get_timestamp_ns()
@@ -757,201 +1646,140 @@ uint64_t mxl_output_data::get_timestamp_ns()
 bool mxl_output_data::convert_to_v210(uint8_t *src_data, enum video_format src_format, 
                                      uint32_t width, uint32_t height, uint32_t *linesize,
                                      uint8_t *dst_data, size_t dst_size,
-                                     uint8_t **data_planes)
+                                     uint8_t **data_planes, size_t dst_stride,
+                                     uint32_t row_begin, uint32_t row_end)
 {
     if (!src_data || !dst_data) {
         return false;
     }
     
-    // v210 format: 10-bit YUV 4:2:2 packed
-    // Each group of 6 pixels = 16 bytes (4 x 32-bit words)
-    // v210 stride must be calculated correctly for the actual width
-    uint32_t v210_stride = ((width + 5) / 6) * 16; // Round up to nearest 6-pixel group, 16 bytes per group
+    mxl_profile_scope scope(PROFILE_CONVERT_TO_V210);
     
-    // Ensure stride is aligned to 4-byte boundary for 32-bit access
-    v210_stride = (v210_stride + 3) & ~3;
+    // v210 format: 10-bit YUV 4:2:2 packed, 16 bytes per group of 6 pixels
+    size_t v210_stride = dst_stride ? dst_stride : v210_line_bytes(width);
+    if (v210_stride * height > dst_size) {
+        blog(LOG_ERROR, "MXL Output: v210 buffer too small (%zu < %zu)", dst_size, v210_stride * height);
+        return false;
+    }
     
-    // Clear the destination buffer first
-    memset(dst_data, 0, dst_size);
+    row_end = std::min(row_end, height);
+    if (row_begin >= row_end) {
+        return false;
+    }
     
-    // Only log conversion details for unsupported formats or first conversion
-    static bool first_conversion = true;
-    if (first_conversion || src_format != VIDEO_FORMAT_NV12) {
-        blog(LOG_DEBUG, "MXL Output: Converting format %d to v210 (%dx%d)", src_format, width, height);
-        first_conversion = false;
+    // Every 6-pixel group gets written below; only line padding and the
+    // space after the last line need clearing, once per frame
+    if (row_begin == 0) {
+        v210_clear_padding(dst_data, v210_stride, width, height, dst_size);
     }
     
-    if (src_format == VIDEO_FORMAT_I420) {
-        // Convert I420 (YUV 4:2:0 planar) to v210 (YUV 4:2:2 10-bit packed)
-        uint8_t *y_plane = src_data;
-        uint8_t *u_plane = src_data + (width * height);
-        uint8_t *v_plane = src_data + (width * height) + (width * height / 4);
-        
-        for (uint32_t y = 0; y < height; y++) {
-            uint8_t *dst_line = dst_data + (y * v210_stride);
-            uint8_t *y_line = y_plane + (y * width);
-            uint8_t *u_line = u_plane + ((y / 2) * (width / 2));
-            uint8_t *v_line = v_plane + ((y / 2) * (width / 2));
-            
-            // Process pixels in groups of 6 for v210 packing
-            for (uint32_t x = 0; x < width; x += 6) {
-                if ((x / 6) * 16 + 16 > v210_stride) break; // Bounds check
-                
-                uint32_t *v210_group = (uint32_t*)(dst_line + ((x / 6) * 16));
-                
-                // Get Y values (convert 8-bit to 10-bit by shifting left 2)
-                uint16_t y0 = (x + 0 < width) ? (y_line[x + 0] << 2) : 0;
-                uint16_t y1 = (x + 1 < width) ? (y_line[x + 1] << 2) : 0;
-                uint16_t y2 = (x + 2 < width) ? (y_line[x + 2] << 2) : 0;
-                uint16_t y3 = (x + 3 < width) ? (y_line[x + 3] << 2) : 0;
-                uint16_t y4 = (x + 4 < width) ? (y_line[x + 4] << 2) : 0;
-                uint16_t y5 = (x + 5 < width) ? (y_line[x + 5] << 2) : 0;
-                
-                // Get U/V values (convert 8-bit to 10-bit)
-                uint16_t u0 = ((x / 2) + 0 < width / 2) ? (u_line[(x / 2) + 0] << 2) : 512;
-                uint16_t u1 = ((x / 2) + 1 < width / 2) ? (u_line[(x / 2) + 1] << 2) : 512;
-                uint16_t u2 = ((x / 2) + 2 < width / 2) ? (u_line[(x / 2) + 2] << 2) : 512;
-                
-                uint16_t v0 = ((x / 2) + 0 < width / 2) ? (v_line[(x / 2) + 0] << 2) : 512;
-                uint16_t v1 = ((x / 2) + 1 < width / 2) ? (v_line[(x / 2) + 1] << 2) : 512;
-                uint16_t v2 = ((x / 2) + 2 < width / 2) ? (v_line[(x / 2) + 2] << 2) : 512;
-                
-                // Clamp to 10-bit range (0-1023)
-                y0 = std::min(y0, (uint16_t)1023); y1 = std::min(y1, (uint16_t)1023);
-                y2 = std::min(y2, (uint16_t)1023); y3 = std::min(y3, (uint16_t)1023);
-                y4 = std::min(y4, (uint16_t)1023); y5 = std::min(y5, (uint16_t)1023);
-                u0 = std::min(u0, (uint16_t)1023); u1 = std::min(u1, (uint16_t)1023); u2 = std::min(u2, (uint16_t)1023);
-                v0 = std::min(v0, (uint16_t)1023); v1 = std::min(v1, (uint16_t)1023); v2 = std::min(v2, (uint16_t)1023);
-                
-                // Pack into v210 format (little-endian, 10 bits per component)
-                // v210 packing: Cb0 Y0 Cr0 | Y1 Cb1 Y2 | Cr1 Y3 Cb2 | Y4 Cr2 Y5
-                v210_group[0] = (u0 & 0x3FF) | ((y0 & 0x3FF) << 10) | ((v0 & 0x3FF) << 20);
-                v210_group[1] = (y1 & 0x3FF) | ((u1 & 0x3FF) << 10) | ((y2 & 0x3FF) << 20);
-                v210_group[2] = (v1 & 0x3FF) | ((y3 & 0x3FF) << 10) | ((u2 & 0x3FF) << 20);
-                v210_group[3] = (y4 & 0x3FF) | ((v2 & 0x3FF) << 10) | ((y5 & 0x3FF) << 20);
-            }
-        }
-        return true;
+    // Only log conversion details for the first conversion
+    if (!conversion_logged.exchange(true)) {
+        blog(LOG_DEBUG, "MXL Output: Converting format %d to v210 (%dx%d, %s packer)", src_format, width, height,
+             v210_isa_name(v210_best_isa()));
     }
-    else if (src_format == VIDEO_FORMAT_NV12) {
-        // Convert NV12 (YUV 4:2:0 semi-planar) to v210 (YUV 4:2:2 10-bit packed)
-        // NV12 has Y plane and interleaved UV plane
-        
-        uint8_t *y_plane = nullptr;
-        uint8_t *uv_plane = nullptr;
-        
-        // Use proper linesize values from OBS
-        uint32_t y_stride = linesize[0];   // Y plane stride (bytes per line)
-        uint32_t uv_stride = linesize[1];  // UV plane stride (bytes per line)
-        
-        // Use the actual image width, not stride (stride includes padding)
-        uint32_t actual_width = width;
-        uint32_t actual_height = height;
+    
+    v210_source source = {};
+    source.width = width;
+    source.height = height;
+    
+    if (to_v210_source_format(src_format, source.format)) {
+        uint32_t plane_count = v210_source_plane_count(source.format);
+        for (uint32_t i = 0; i < plane_count; i++) {
+            source.linesize[i] = linesize[i];
+        }
         
-        // Check if OBS provides separate data planes (like CDI example)
-        if (data_planes && data_planes[0] && data_planes[1]) {
-            // OBS provides separate Y and UV planes
-            y_plane = data_planes[0];
-            uv_plane = data_planes[1];
+        if (data_planes && data_planes[0] && (plane_count < 2 || data_planes[1]) &&
+            (plane_count < 3 || data_planes[2])) {
+            // OBS provides separate planes
+            for (uint32_t i = 0; i < plane_count; i++) {
+                source.planes[i] = data_planes[i];
+            }
+        } else if (src_format == VIDEO_FORMAT_NV12 || src_format == VIDEO_FORMAT_I420) {
+            // Fallback: single buffer with the planes stored back to back
+            source.planes[0] = src_data;
+            source.planes[1] = src_data + static_cast<size_t>(linesize[0]) * height;
+            if (plane_count == 3) {
+                source.planes[2] = source.planes[1] + static_cast<size_t>(linesize[1]) * ((height + 1) / 2);
+            }
         } else {
-            // Fallback: OBS provides single buffer with Y followed by UV
-            y_plane = src_data;
-            uv_plane = src_data + (y_stride * actual_height);
+            blog(LOG_ERROR, "MXL Output: Missing planes for format %d", src_format);
+            return false;
         }
         
-        for (uint32_t y = 0; y < actual_height; y++) {
-            uint8_t *dst_line = dst_data + (y * v210_stride);
-            uint8_t *y_line = y_plane + (y * y_stride);
-            // NV12 UV plane: UV data is at half vertical resolution
-            uint8_t *uv_line = uv_plane + ((y / 2) * uv_stride);
-            
-            // Process pixels in groups of 6 for v210 packing
-            for (uint32_t x = 0; x < actual_width; x += 6) {
-                if ((x / 6) * 16 + 16 > v210_stride) break; // Bounds check
-                
-                uint32_t *v210_group = (uint32_t*)(dst_line + ((x / 6) * 16));
-                
-                // Get Y values (convert 8-bit to 10-bit)
-                uint16_t y0 = (x + 0 < actual_width) ? (y_line[x + 0] << 2) : 0;
-                uint16_t y1 = (x + 1 < actual_width) ? (y_line[x + 1] << 2) : 0;
-                uint16_t y2 = (x + 2 < actual_width) ? (y_line[x + 2] << 2) : 0;
-                uint16_t y3 = (x + 3 < actual_width) ? (y_line[x + 3] << 2) : 0;
-                uint16_t y4 = (x + 4 < actual_width) ? (y_line[x + 4] << 2) : 0;
-                uint16_t y5 = (x + 5 < actual_width) ? (y_line[x + 5] << 2) : 0;
-                
-                // Get U/V values from interleaved UV plane
-                // NV12: UV plane has U,V,U,V... interleaved at half horizontal resolution
-                uint16_t u0, v0, u1, v1, u2, v2;
-                
-                // For 6 pixels (x to x+5), we need 3 UV pairs
-                // UV pair 0: covers pixels x+0, x+1
-                uint32_t uv_x0 = (x / 2) * 2;  // UV index for pixel pair
-                if (uv_x0 + 1 < uv_stride && uv_x0 < actual_width) {
-                    u0 = (uv_line[uv_x0 + 0] << 2);
-                    v0 = (uv_line[uv_x0 + 1] << 2);
-                } else {
-                    u0 = v0 = 512; // Neutral chroma (128 << 2)
-                }
-                
-                // UV pair 1: covers pixels x+2, x+3
-                uint32_t uv_x1 = ((x + 2) / 2) * 2;
-                if (uv_x1 + 1 < uv_stride && uv_x1 < actual_width) {
-                    u1 = (uv_line[uv_x1 + 0] << 2);
-                    v1 = (uv_line[uv_x1 + 1] << 2);
-                } else {
-                    u1 = v1 = 512;
-                }
-                
-                // UV pair 2: covers pixels x+4, x+5
-                uint32_t uv_x2 = ((x + 4) / 2) * 2;
-                if (uv_x2 + 1 < uv_stride && uv_x2 < actual_width) {
-                    u2 = (uv_line[uv_x2 + 0] << 2);
-                    v2 = (uv_line[uv_x2 + 1] << 2);
-                } else {
-                    u2 = v2 = 512;
-                }
-                
-                // Clamp to 10-bit range
-                y0 = std::min(y0, (uint16_t)1023); y1 = std::min(y1, (uint16_t)1023);
-                y2 = std::min(y2, (uint16_t)1023); y3 = std::min(y3, (uint16_t)1023);
-                y4 = std::min(y4, (uint16_t)1023); y5 = std::min(y5, (uint16_t)1023);
-                u0 = std::min(u0, (uint16_t)1023); u1 = std::min(u1, (uint16_t)1023); u2 = std::min(u2, (uint16_t)1023);
-                v0 = std::min(v0, (uint16_t)1023); v1 = std::min(v1, (uint16_t)1023); v2 = std::min(v2, (uint16_t)1023);
-                
-                // Pack into v210 format: Cb0 Y0 Cr0 | Y1 Cb1 Y2 | Cr1 Y3 Cb2 | Y4 Cr2 Y5
-                // Note: Cb = U, Cr = V
-                v210_group[0] = (u0 & 0x3FF) | ((y0 & 0x3FF) << 10) | ((v0 & 0x3FF) << 20);
-                v210_group[1] = (y1 & 0x3FF) | ((u1 & 0x3FF) << 10) | ((y2 & 0x3FF) << 20);
-                v210_group[2] = (v1 & 0x3FF) | ((y3 & 0x3FF) << 10) | ((u2 & 0x3FF) << 20);
-                v210_group[3] = (y4 & 0x3FF) | ((v2 & 0x3FF) << 10) | ((y5 & 0x3FF) << 20);
-            }
+        v210_band_job job = {&source, dst_data, v210_stride, v210_best_isa(), row_begin, nullptr};
+        // A zero-row call only validates the source, so bands cannot fail halfway
+        if (!v210_pack_rows(source, dst_data, v210_stride, job.isa, 0, 0)) {
+            return false;
+        }
+        proxy_band_job proxy = {};
+        if (proxy_payload && downscale_rows(source, proxy_scale, proxy_frame, 0, 0)) {
+            proxy = {&source, proxy_scale, proxy_frame, downscale_frame_source(proxy_frame, source.format),
+                     proxy_payload, proxy_stride, job.isa, false};
+            job.proxy = &proxy;
         }
+        convert_pool.run(row_end - row_begin, pack_v210_band, &job);
         return true;
     }
     
-    // For unsupported formats, create a simple test pattern
-    blog(LOG_WARNING, "MXL Output: Format %d to v210 conversion not fully implemented, creating test pattern", src_format);
+    // choose_video_conversion asks OBS for a packable format, so this is
+    // only reached if OBS delivers something else
+    if (!unsupported_format_logged.exchange(true)) {
+        blog(LOG_ERROR, "MXL Output: Format %s cannot be packed to v210, dropping frames",
+             get_video_format_name(src_format));
+    }
+    return false;
+}
+
+bool mxl_output_data::convert_to_uyvy(uint8_t **data_planes, uint32_t *linesize, enum video_format src_format,
+                                      uint32_t width, uint32_t height,
+                                      uint8_t *dst_data, size_t dst_size, size_t dst_stride,
+                                      uint32_t row_begin, uint32_t row_end)
+{
+    if (!data_planes || !dst_data) {
+        return false;
+    }
     
-    // Create a simple gradient test pattern in v210 format
-    for (uint32_t y = 0; y < height; y++) {
-        uint8_t *dst_line = dst_data + (y * v210_stride);
-        
-        for (uint32_t x = 0; x < width; x += 6) {
-            if ((x / 6) * 16 + 16 > v210_stride) break;
-            
-            uint32_t *v210_group = (uint32_t*)(dst_line + ((x / 6) * 16));
-            
-            // Create a gradient pattern
-            uint16_t luma = ((x + y) % 256) << 2; // 8-bit to 10-bit
-            uint16_t chroma = 512; // Neutral chroma
-            
-            // Pack the same pattern for all 6 pixels
-            v210_group[0] = (chroma & 0x3FF) | ((luma & 0x3FF) << 10) | ((chroma & 0x3FF) << 20);
-            v210_group[1] = (luma & 0x3FF) | ((chroma & 0x3FF) << 10) | ((luma & 0x3FF) << 20);
-            v210_group[2] = (chroma & 0x3FF) | ((luma & 0x3FF) << 10) | ((chroma & 0x3FF) << 20);
-            v210_group[3] = (luma & 0x3FF) | ((chroma & 0x3FF) << 10) | ((luma & 0x3FF) << 20);
+    mxl_profile_scope scope(PROFILE_CONVERT_TO_UYVY);
+    
+    v210_source source = {};
+    source.width = width;
+    source.height = height;
+    if (!to_v210_source_format(src_format, source.format) || !uyvy_source_supported(source.format)) {
+        if (!unsupported_format_logged.exchange(true)) {
+            blog(LOG_ERROR, "MXL Output: Format %s cannot be packed to UYVY, dropping frames",
+                 get_video_format_name(src_format));
         }
+        return false;
+    }
+    for (uint32_t i = 0; i < v210_source_plane_count(source.format); i++) {
+        source.planes[i] = data_planes[i];
+        source.linesize[i] = linesize[i];
+    }
+    
+    if (dst_stride * height > dst_size) {
+        blog(LOG_ERROR, "MXL Output: UYVY buffer too small (%zu < %zu)", dst_size, dst_stride * height);
+        return false;
+    }
+    row_end = std::min(row_end, height);
+    if (row_begin >= row_end) {
+        return false;
+    }
+    if (row_begin == 0) {
+        uyvy_clear_padding(dst_data, dst_stride, width, height, dst_size);
     }
     
+    v210_band_job job = {&source, dst_data, dst_stride, V210_ISA_SCALAR, row_begin, nullptr};
+    // A zero-row call only validates the source, so bands cannot fail halfway
+    if (!uyvy_pack_rows(source, dst_data, dst_stride, 0, 0)) {
+        return false;
+    }
+    proxy_band_job proxy = {};
+    if (proxy_payload && downscale_rows(source, proxy_scale, proxy_frame, 0, 0)) {
+        proxy = {&source, proxy_scale, proxy_frame, downscale_frame_source(proxy_frame, source.format),
+                 proxy_payload, proxy_stride, V210_ISA_SCALAR, true};
+        job.proxy = &proxy;
+    }
+    convert_pool.run(row_end - row_begin, pack_uyvy_band, &job);
     return true;
 }
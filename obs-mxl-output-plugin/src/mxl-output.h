@@ -9,33 +9,132 @@
 #include <mxl/mxl.h>
 #include <mxl/flow.h>
 #include <mxl/flowinfo.h>
+#include "mxl-frame-pool.h"
+#include "mxl-frame-queue.h"
+#include "mxl-band-pool.h"
+#include "mxl-downscale.h"
+#include "mxl-clock.h"
+#include <memory>
 #include <string>
+#include <vector>
 #include <thread>
 #include <atomic>
 #include <mutex>
-#include <queue>
 #include <condition_variable>
 #include <filesystem>
 #include <fstream>
 
-struct video_frame_data {
-    uint8_t *data;
+// Default and upper bound for the queued path's frame ring
+constexpr uint32_t MXL_VIDEO_QUEUE_DEPTH_DEFAULT = 2;
+constexpr uint32_t MXL_VIDEO_QUEUE_DEPTH_MAX = 16;
+constexpr uint32_t MXL_VIDEO_SLICE_BATCHES_MAX = 64;
+// Paired OBS/MXL clock readings taking longer than this were preempted
+constexpr uint64_t MXL_CLOCK_READ_WINDOW_NS = 50000;
+
+// Frame format the output asks OBS for. AUTO requests a format the v210
+// packers read directly (4:2:2 where OBS has more than 4:2:0 chroma) and
+// leaves formats they already handle alone; NATIVE takes OBS's output
+// format as is.
+enum mxl_video_conversion {
+    MXL_CONVERSION_AUTO,
+    MXL_CONVERSION_NATIVE,
+    MXL_CONVERSION_I422,
+    MXL_CONVERSION_P216,
+    MXL_CONVERSION_I210,
+};
+
+const char *mxl_video_conversion_name(mxl_video_conversion conversion);
+// Unknown names fall back to AUTO
+mxl_video_conversion mxl_video_conversion_from_name(const char *name);
+
+// Pixel layout of the video flow. V210 is MXL's native 10-bit 4:2:2; UYVY is
+// 8-bit 4:2:2 (NMOS video/raw) for consumers that read it directly and
+// only needs a byte interleave. SDKs that reject video/raw flows get V210.
+enum mxl_video_packing {
+    MXL_PACKING_V210,
+    MXL_PACKING_UYVY,
+};
+
+const char *mxl_video_packing_name(mxl_video_packing packing);
+// Unknown names fall back to V210
+mxl_video_packing mxl_video_packing_from_name(const char *name);
+
+// How the selected mixer tracks map onto audio flows
+enum mxl_audio_layout {
+    // One flow per mixer track
+    MXL_AUDIO_LAYOUT_TRACKS,
+    // One flow holding every mixer's channels side by side, in track order
+    MXL_AUDIO_LAYOUT_WIDE,
+};
+
+// What goes into video grains OBS did not deliver a frame for
+enum mxl_video_gap_policy {
+    // Grains flagged invalid, with no payload
+    MXL_GAP_INVALID,
+    // The last committed grain's payload again
+    MXL_GAP_REPEAT,
+};
+
+const char *mxl_video_gap_policy_name(mxl_video_gap_policy policy);
+// Unknown names fall back to INVALID
+mxl_video_gap_policy mxl_video_gap_policy_from_name(const char *name);
+
+const char *mxl_audio_layout_name(mxl_audio_layout layout);
+// Unknown names fall back to TRACKS
+mxl_audio_layout mxl_audio_layout_from_name(const char *name);
+
+// One MXL audio flow with its index state. It carries either a single OBS
+// mixer track or, in the wide layout, all of them.
+struct mxl_audio_track {
+    // OBS mix index (0-based) delivered through raw_audio2; the first one
+    // for a wide flow
+    size_t mix_idx;
+    std::string flow_id;
+    mxlFlowWriter writer;
+    mxlFlowConfigInfo config;
+    uint32_t channel_count;
+    uint64_t last_index_end;
+    bool last_index_valid;
+
+    // Wide layout only: the aggregated mixers (bit i = mix i), each filling
+    // channels_per_mixer channels. 0 for a single-track flow.
+    uint32_t wide_mixers;
+    uint32_t channels_per_mixer;
+    // Slice opened by the first mixer of an audio block; committed once
+    // every mixer in wide_pending has written its channels
+    mxlMutableWrappedMultiBufferSlice wide_payload;
+    bool wide_open;
+    uint32_t wide_pending;
+    uint64_t wide_timestamp;
+    uint64_t wide_start;
+    uint32_t wide_frames;
+
+    mxl_audio_track()
+        : mix_idx(0), writer(nullptr), config{}, channel_count(0), last_index_end(0), last_index_valid(false),
+          wide_mixers(0), channels_per_mixer(0), wide_payload{}, wide_open(false), wide_pending(0),
+          wide_timestamp(0), wide_start(0), wide_frames(0) {}
+};
+
+// Reads a flow's last good grain back for MXL_GAP_REPEAT. Nothing is kept per
+// frame; the grain is fetched once per gap through a reader on the output's
+// own flow, and staged only when one of the gap's grains would overwrite its
+// ring slot first.
+struct mxl_repeat_source {
+    mxlFlowReader reader;
+    const uint8_t *payload;
     size_t size;
-    uint64_t timestamp;
-    uint32_t width;
-    uint32_t height;
-    enum video_format format;
-    
-    video_frame_data() : data(nullptr), size(0), timestamp(0), width(0), height(0), format(VIDEO_FORMAT_NONE) {}
-    ~video_frame_data() {
-        if (data) {
-            bfree(data);
-            data = nullptr;
-        }
-    }
+    std::vector<uint8_t> staging;
+
+    mxl_repeat_source() : reader(nullptr), payload(nullptr), size(0) {}
 };
 
+// Bit i of a mixer mask selects OBS audio track i + 1
+constexpr uint32_t MXL_AUDIO_MIXERS_DEFAULT = 0x1;
 
+// Flow ID for an extra track when none is configured: the base flow ID with
+// the track number folded into its last byte, so it stays the same across
+// restarts
+std::string mxl_derive_track_flow_id(const std::string &base_flow_id, size_t mix_idx);
 
 struct mxl_output_data {
     // OBS output
@@ -45,15 +144,58 @@ struct mxl_output_data {
     mxlInstance mxl_instance;
     mxlFlowWriter video_flow_writer;
     mxlFlowConfigInfo flow_config;
-    mxlFlowWriter audio_flow_writer;
-    mxlFlowConfigInfo audio_flow_config;
+    // One entry per mixer in audio_mixers, in track order
+    std::vector<mxl_audio_track> audio_tracks;
+    // OBS mix index -> entry in audio_tracks, -1 when the mixer is not sent.
+    // Every selected mixer maps to entry 0 in the wide layout.
+    int audio_track_for_mix[MAX_AUDIO_MIXES];
     
     // Configuration
     std::string domain_path;
     std::string video_flow_id;
+    // Flow of the first track in audio_mixers; later tracks use
+    // audio_track_flow_ids in order, or IDs derived from this one
     std::string audio_flow_id;
+    std::vector<std::string> audio_track_flow_ids;
+    uint32_t audio_mixers;
+    mxl_audio_layout audio_layout;
     bool video_enabled;
     bool audio_enabled;
+    // Convert into the grain on the OBS video thread instead of queueing a
+    // copy of the frame for the output thread to convert
+    bool direct_grain_write;
+    uint32_t video_queue_depth;
+    mxl_drop_policy video_drop_policy;
+    // Threads packing one frame in row bands; 0 picks a count from the resolution
+    uint32_t convert_threads;
+    mxl_video_conversion video_conversion;
+    mxl_video_packing video_packing;
+    // Partial commits per video grain; 1 commits each grain once when it is complete
+    uint32_t video_slice_batches;
+    mxl_video_gap_policy video_gap_policy;
+    // Last good grain and proxy grain for MXL_GAP_REPEAT; readers exist only
+    // with that policy
+    mxl_repeat_source repeat_video;
+    mxl_repeat_source repeat_proxy;
+    // Scene or source rendered through a dedicated view instead of the
+    // program mix; empty publishes the program (see mxl-view.h)
+    std::string view_source;
+    video_t *view_video;
+    // Companion flow at 1/proxy_scale of the video size (0 = none). The same
+    // band jobs that pack the main grain downscale the source planes and
+    // pack the proxy grain.
+    uint32_t proxy_scale;
+    std::string proxy_flow_id;
+    mxlFlowWriter proxy_flow_writer;
+    mxlFlowConfigInfo proxy_flow_config;
+    uint32_t proxy_width;
+    uint32_t proxy_height;
+    // Downscaled frame in the source's format, between downscale and pack
+    std::unique_ptr<uint8_t[]> proxy_buffer;
+    downscale_frame proxy_frame;
+    // Proxy grain open alongside the main grain, nullptr when there is none
+    uint8_t *proxy_payload;
+    size_t proxy_stride;
     
     // Video properties
     uint32_t video_width;
@@ -70,23 +212,43 @@ struct mxl_output_data {
     std::thread output_thread;
     std::atomic<bool> thread_active;
     std::atomic<bool> output_active;
+    // Data capture began and the deactivate signal has not torn down yet
+    std::atomic<bool> capture_active;
+    
+    // Band workers for convert_to_v210
+    mxl_band_pool convert_pool;
+    
+    // Preallocated source frames for the queued path; declared before the
+    // queue so queued frames are recycled before the pool goes away
+    mxl_frame_pool video_pool;
     
-    // Frame queues
-    std::queue<std::unique_ptr<video_frame_data>> video_queue;
+    // Frame queue; the mutex only backs the condition variable wait
+    mxl_frame_queue video_queue;
     std::mutex video_queue_mutex;
     std::condition_variable frame_condition;
+    // Frames OBS delivered that never became a grain (queue drops, empty
+    // pool, failed conversions or writes)
+    std::atomic<uint64_t> dropped_video_frames;
+    // Gap grains filled with the last frame; not counted in video_grain_index
+    std::atomic<uint64_t> repeated_video_grains;
+    // Log throttling, per output so several outputs don't mix their counts
+    uint64_t received_video_frames;
+    uint64_t pool_empty_count;
+    uint64_t last_logged_video_grain;
+    // Set by whichever band worker logs the first conversion
+    std::atomic<bool> conversion_logged;
+    // Set once a frame in a format the packers can't read has been reported
+    std::atomic<bool> unsupported_format_logged;
     
     // Grain indexing
     std::atomic<uint64_t> video_grain_index;
     uint64_t last_grain_index;
     bool last_grain_index_valid;
-    int64_t mxl_time_offset_ns;
-    bool has_time_offset;
-    uint64_t last_audio_index_end;
-    bool last_audio_index_valid;
-    int64_t audio_time_offset_ns;
-    bool audio_has_time_offset;
     std::mutex audio_mutex;
+    // Time base for video and audio alike: OBS clock -> MXL time, set at
+    // output start and followed for drift over the whole run, so grains and
+    // samples with the same OBS timestamp land at the same MXL time
+    mxl_clock_tracker mxl_clock;
     
     // Timing
     uint64_t start_timestamp;
@@ -98,29 +260,86 @@ struct mxl_output_data {
     
     // Methods
     bool initialize_mxl();
+    // Frees the writers, pools and audio tracks the raw callbacks use; call
+    // only once they can no longer run (the output's deactivate signal)
     void cleanup_mxl();
     bool create_video_flow();
-    bool create_audio_flow();
+    // Needs video_format, so it runs once the frame format is negotiated
+    bool create_proxy_flow();
+    bool open_proxy_grain(uint64_t grain_index, mxlGrainInfo &grain_info);
+    void close_proxy_grain(uint64_t grain_index, mxlGrainInfo &grain_info, bool commit);
+    bool create_audio_flows();
+    bool create_audio_flow(mxl_audio_track &track);
     void output_loop();
-    bool process_video_frame(std::unique_ptr<video_frame_data> frame);
+    bool process_video_frame(video_frame_ptr frame);
+    bool write_video_frame_direct(struct video_data *frame);
+    bool write_video_grain(uint8_t **planes, uint32_t *linesize, uint64_t timestamp);
+    uint64_t next_video_grain_index(uint64_t timestamp);
+    // Feed mxl_clock one paired reading of both clocks
+    void sample_mxl_clock();
+    // Start a new time base; called when the output starts
+    void reset_time_base();
+    // MXL time of an OBS timestamp on the shared time base
+    uint64_t to_mxl_time(uint64_t timestamp);
+    bool commit_video_grain(uint64_t grain_index, mxlGrainInfo &grain_info);
     bool write_invalid_grain(uint64_t grain_index);
-    bool write_audio_samples(struct audio_data *frames);
-    bool write_silence_samples(uint64_t start_index, uint64_t count);
+    // Opens a reader on `flow_id` for MXL_GAP_REPEAT; false leaves gaps invalid
+    bool open_repeat_source(mxl_repeat_source &source, const std::string &flow_id);
+    void close_repeat_source(mxl_repeat_source &source);
+    // Points `source` at grain `index` of its flow, staging a copy when one of
+    // the grains from `fill_begin` to `fill_end` reuses its slot
+    bool fetch_repeat_source(mxl_repeat_source &source, uint64_t index, uint32_t grain_count,
+                             uint64_t fill_begin, uint64_t fill_end);
+    // Commits the fetched payloads into `grain_index`; false when there is
+    // nothing to repeat
+    bool write_repeat_grain(uint64_t grain_index);
+    // Proxy grain for a gap in the main flow; `repeat` copies the fetched
+    // proxy payload when there is one
+    void write_proxy_gap_grain(uint64_t grain_index, bool repeat);
+    bool write_audio_samples(mxl_audio_track &track, struct audio_data *frames);
+    bool write_silence_samples(mxl_audio_track &track, uint64_t start_index, uint64_t count);
+    // Wide layout: write mixer `mix_idx` into its channels of the open block
+    bool write_wide_audio_samples(mxl_audio_track &track, size_t mix_idx, struct audio_data *frames);
+    bool commit_wide_samples(mxl_audio_track &track);
+    // Flow index for the first sample of `frames`; fills any gap since the
+    // last write with silence. Call with audio_mutex held.
+    uint64_t audio_start_index(mxl_audio_track &track, const struct audio_data *frames);
+    mxl_audio_track *audio_track_for(size_t mix_idx);
     
     // Format conversion helpers
+    // Fills `conversion` and returns true when OBS should convert its output
+    // frames for us; false means take them as they are
+    bool choose_video_conversion(const struct obs_video_info &ovi, struct video_scale_info &conversion) const;
     std::string get_mxl_video_media_type(enum video_format format);
     size_t calculate_video_frame_size(enum video_format format, uint32_t width, uint32_t height);
+    // Packed bytes of one flow line of `width` pixels for video_packing
+    size_t video_line_bytes() const { return video_line_bytes(video_width); }
+    size_t video_line_bytes(uint32_t width) const;
+    // Queued frames plus the one being converted and the one being filled
+    uint32_t video_pool_size() const { return video_queue_depth + 2; }
     
-    // v210 conversion
+    // v210 conversion; dst_stride 0 means tightly packed lines. Only rows
+    // [row_begin, row_end) are packed; the padding is cleared with row 0.
     bool convert_to_v210(uint8_t *src_data, enum video_format src_format, 
                         uint32_t width, uint32_t height, uint32_t *linesize,
                         uint8_t *dst_data, size_t dst_size,
-                        uint8_t **data_planes = nullptr);
+                        uint8_t **data_planes = nullptr, size_t dst_stride = 0,
+                        uint32_t row_begin = 0, uint32_t row_end = UINT32_MAX);
+    // UYVY packing of separate 8-bit YUV planes into lines of dst_stride bytes
+    bool convert_to_uyvy(uint8_t **data_planes, uint32_t *linesize, enum video_format src_format,
+                         uint32_t width, uint32_t height,
+                         uint8_t *dst_data, size_t dst_size, size_t dst_stride,
+                         uint32_t row_begin = 0, uint32_t row_end = UINT32_MAX);
     
     // Flow descriptor creation
     bool create_video_flow_descriptor();
     bool create_audio_flow_descriptor();
-    std::string generate_flow_descriptor_json(bool is_video);
+    // `track` picks the audio flow; nullptr means the first track
+    std::string generate_flow_descriptor_json(bool is_video, const mxl_audio_track *track = nullptr);
+    // Video flow of the given size; a non-empty `parent_id` marks it as
+    // derived from that flow
+    std::string generate_video_descriptor_json(const std::string &flow_id, uint32_t width, uint32_t height,
+                                               const std::string &label_prefix, const std::string &parent_id);
     
     // Utility methods
     std::string generate_uuid();
@@ -0,0 +1,99 @@
+#include "mxl-view.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+struct mxl_view_entry {
+    std::string source_name;
+    struct video_scale_info format;
+    obs_view_t *view;
+    video_t *video;
+    struct obs_video_info ovi;
+    uint32_t refs;
+};
+
+std::mutex views_mutex;
+std::vector<std::unique_ptr<mxl_view_entry>> views;
+
+bool same_format(const struct video_scale_info &a, const struct video_scale_info &b)
+{
+    return a.format == b.format && a.width == b.width && a.height == b.height && a.range == b.range &&
+           a.colorspace == b.colorspace;
+}
+} // namespace
+
+video_t *mxl_view_acquire(const std::string &source_name, const struct video_scale_info &format,
+                          struct obs_video_info &ovi)
+{
+    std::lock_guard<std::mutex> lock(views_mutex);
+    for (const auto &entry : views) {
+        if (entry->source_name == source_name && same_format(entry->format, format)) {
+            entry->refs++;
+            ovi = entry->ovi;
+            blog(LOG_INFO, "MXL Output: Sharing view of '%s' (%u outputs)", source_name.c_str(), entry->refs);
+            return entry->video;
+        }
+    }
+
+    if (!obs_get_video_info(&ovi)) {
+        return nullptr;
+    }
+    obs_source_t *source = obs_get_source_by_name(source_name.c_str());
+    if (!source) {
+        blog(LOG_ERROR, "MXL Output: Source '%s' not found", source_name.c_str());
+        return nullptr;
+    }
+
+    // Scenes cover the canvas; a single source is rendered at its own size
+    // so it fills the frame instead of sitting in the canvas's corner
+    if (!obs_source_is_scene(source) && obs_source_get_width(source) > 0 && obs_source_get_height(source) > 0) {
+        ovi.base_width = obs_source_get_width(source);
+        ovi.base_height = obs_source_get_height(source);
+    }
+    ovi.output_width = format.width;
+    ovi.output_height = format.height;
+    ovi.output_format = format.format;
+    ovi.range = format.range;
+    ovi.colorspace = format.colorspace;
+
+    obs_view_t *view = obs_view_create();
+    obs_view_set_source(view, 0, source);
+    obs_source_release(source);
+    video_t *video = obs_view_add2(view, &ovi);
+    if (!video) {
+        blog(LOG_ERROR, "MXL Output: Failed to add a view for '%s' at %ux%u", source_name.c_str(), format.width,
+             format.height);
+        obs_view_set_source(view, 0, nullptr);
+        obs_view_destroy(view);
+        return nullptr;
+    }
+
+    views.push_back(std::unique_ptr<mxl_view_entry>(new mxl_view_entry{source_name, format, view, video, ovi, 1}));
+    blog(LOG_INFO, "MXL Output: Rendering '%s' through its own view (%ux%u from %ux%u, %s)", source_name.c_str(),
+         ovi.output_width, ovi.output_height, ovi.base_width, ovi.base_height,
+         get_video_format_name(ovi.output_format));
+    return video;
+}
+
+void mxl_view_release(video_t *video)
+{
+    if (!video) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(views_mutex);
+    for (auto it = views.begin(); it != views.end(); ++it) {
+        mxl_view_entry &entry = **it;
+        if (entry.video != video) {
+            continue;
+        }
+        if (--entry.refs == 0) {
+            obs_view_remove(entry.view);
+            obs_view_set_source(entry.view, 0, nullptr);
+            obs_view_destroy(entry.view);
+            blog(LOG_INFO, "MXL Output: Removed view of '%s'", entry.source_name.c_str());
+            views.erase(it);
+        }
+        return;
+    }
+}
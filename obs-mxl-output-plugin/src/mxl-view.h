@@ -0,0 +1,26 @@
+#pragma once
+
+#include <obs-module.h>
+#include <media-io/video-io.h>
+#include <cstdint>
+#include <string>
+
+// Renders one OBS scene or source through its own obs_view, so an output can
+// publish it instead of the program mix. The view's video mix is created at
+// the flow's size and in the frame format the flow wants, so the GPU does
+// the scaling and conversion. Outputs that ask for the same source, size and
+// format share one view: the source is rendered and converted once, however
+// many flows read it.
+//
+// Needs obs_view_add2 (OBS 30.1 or newer).
+
+// Returns the view's video output, or nullptr when the source does not exist
+// or the view could not be added. `ovi` is filled with the view's video info.
+// Call from the UI thread or an output's start callback.
+video_t *mxl_view_acquire(const std::string &source_name, const struct video_scale_info &format,
+                          struct obs_video_info &ovi);
+
+// Drops one reference; the last one removes and destroys the view. Call only
+// once the output reading the video has ended capture (its "deactivate"
+// signal) and been pointed back at another video_t.
+void mxl_view_release(video_t *video);
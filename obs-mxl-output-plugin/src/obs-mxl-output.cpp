@@ -3,8 +3,14 @@
 #include "mxl-output.h"
 #include "mxl-config.h"
 #include "mxl-native-dialog.h"
+#include "mxl-trace.h"
 #include <thread>
 #include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <inttypes.h>
 
 // Version information
 #define MXL_OUTPUT_PLUGIN_VERSION "0.0.1-alpha"
@@ -15,9 +21,18 @@ OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE("obs-mxl-output-plugin", "en-US")
 
 // Global components
+// Output of the main profile; the settings dialog reports its state
 obs_output_t* global_mxl_output = nullptr;
 static MXLConfig* global_config = nullptr;
 
+// Outputs of the extra profiles in MXLConfig::Profiles. Each one is a separate
+// OBS output with its own MXL instance, writer thread, frame pool and stats.
+struct mxl_profile_output {
+    std::string name;
+    obs_output_t* output;
+};
+static std::vector<mxl_profile_output> profile_outputs;
+
 // Module information
 MODULE_EXPORT const char *obs_module_description(void)
 {
@@ -31,39 +46,121 @@ MODULE_EXPORT const char *obs_module_name(void)
 
 // Helper functions
 namespace {
+    obs_output_t* create_profile_output(const MXLConfig& profile) {
+        obs_data_t* settings = obs_data_create();
+        obs_data_set_string(settings, "profile_name", profile.Name.c_str());
+        obs_data_set_string(settings, "domain_path", profile.DomainPath.c_str());
+        obs_data_set_string(settings, "video_flow_id", profile.VideoFlowId.c_str());
+        obs_data_set_bool(settings, "video_enabled", profile.VideoEnabled);
+        obs_data_set_string(settings, "audio_flow_id", profile.AudioFlowId.c_str());
+        obs_data_set_bool(settings, "audio_enabled", profile.AudioEnabled);
+        obs_data_set_int(settings, "audio_mixers", profile.AudioMixers);
+        obs_data_set_string(settings, "audio_track_flow_ids", profile.AudioTrackFlowIds.c_str());
+        obs_data_set_string(settings, "audio_layout", profile.AudioLayout.c_str());
+        obs_data_set_bool(settings, "direct_grain_write", profile.DirectGrainWrite);
+        obs_data_set_int(settings, "video_queue_depth", profile.VideoQueueDepth);
+        obs_data_set_string(settings, "video_drop_policy", profile.VideoDropPolicy.c_str());
+        obs_data_set_int(settings, "conversion_threads", profile.ConversionThreads);
+        obs_data_set_string(settings, "video_conversion", profile.VideoConversion.c_str());
+        obs_data_set_string(settings, "video_media_type", profile.VideoMediaType.c_str());
+        obs_data_set_int(settings, "video_slice_batches", profile.VideoSliceBatches);
+        obs_data_set_string(settings, "video_gap_policy", profile.VideoGapPolicy.c_str());
+        obs_data_set_string(settings, "view_source", profile.Source.c_str());
+        obs_data_set_int(settings, "output_width", profile.OutputWidth);
+        obs_data_set_int(settings, "output_height", profile.OutputHeight);
+        obs_data_set_int(settings, "proxy_scale", profile.ProxyScale);
+        obs_data_set_string(settings, "proxy_flow_id", profile.ProxyFlowId.c_str());
+        
+        std::string name = profile.Name.empty() ? "MXL Output" : "MXL Output (" + profile.Name + ")";
+        obs_output_t* output = obs_output_create("mxl_raw_output", name.c_str(), settings, nullptr);
+        if (!output) {
+            blog(LOG_ERROR, "MXL Output: Failed to create output %s", name.c_str());
+        }
+        obs_data_release(settings);
+        return output;
+    }
+    
+    void start_profile_output(obs_output_t* output, const std::string& name) {
+        if (output && !obs_output_active(output)) {
+            if (obs_output_start(output)) {
+                blog(LOG_INFO, "MXL Output: Output %s started successfully", name.c_str());
+            } else {
+                blog(LOG_ERROR, "MXL Output: Failed to start output %s", name.c_str());
+            }
+        }
+    }
+    
+    void stop_profile_output(obs_output_t* output) {
+        if (output && obs_output_active(output)) {
+            obs_output_stop(output);
+        }
+    }
+    
+    // The proxy flow gets its ID on first use, like the flows of extra profiles
+    bool assign_missing_proxy_flow_id(MXLConfig& profile) {
+        if (profile.VideoEnabled && profile.ProxyScale > 1 && profile.ProxyFlowId.empty()) {
+            profile.ProxyFlowId = MXLNativeDialog::GenerateUUID();
+            return true;
+        }
+        return false;
+    }
+    
+    // Extra profiles get flow IDs on first use; they are saved so the flows
+    // keep their IDs across restarts
+    bool assign_missing_flow_ids(MXLConfig& profile) {
+        bool assigned = assign_missing_proxy_flow_id(profile);
+        if (profile.VideoEnabled && profile.VideoFlowId.empty()) {
+            profile.VideoFlowId = MXLNativeDialog::GenerateUUID();
+            assigned = true;
+        }
+        if (profile.AudioEnabled && profile.AudioFlowId.empty()) {
+            profile.AudioFlowId = MXLNativeDialog::GenerateUUID();
+            assigned = true;
+        }
+        return assigned;
+    }
+    
+    mxl_profile_output* find_profile_output(const std::string& name) {
+        for (mxl_profile_output& entry : profile_outputs) {
+            if (entry.name == name) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+    
     void mxl_output_start_if_enabled() {
         if (!global_config) return;
         
+        bool flow_ids_assigned = false;
         if (global_config->OutputEnabled) {
             blog(LOG_INFO, "MXL Output: Starting output");
             
+            flow_ids_assigned |= assign_missing_proxy_flow_id(*global_config);
             if (!global_mxl_output) {
-                // Create output instance
-                obs_data_t* settings = obs_data_create();
-                obs_data_set_string(settings, "domain_path", global_config->DomainPath.c_str());
-                obs_data_set_string(settings, "video_flow_id", global_config->VideoFlowId.c_str());
-                obs_data_set_bool(settings, "video_enabled", global_config->VideoEnabled);
-                obs_data_set_string(settings, "audio_flow_id", global_config->AudioFlowId.c_str());
-                obs_data_set_bool(settings, "audio_enabled", global_config->AudioEnabled);
-                
-                global_mxl_output = obs_output_create("mxl_raw_output", "MXL Output", settings, nullptr);
-                
-                if (!global_mxl_output) {
-                    blog(LOG_ERROR, "MXL Output: Failed to create output");
-                    obs_data_release(settings);
-                    return;
-                }
-                
-                obs_data_release(settings);
+                global_mxl_output = create_profile_output(*global_config);
             }
-            
-            if (global_mxl_output && !obs_output_active(global_mxl_output)) {
-                if (obs_output_start(global_mxl_output)) {
-                    blog(LOG_INFO, "MXL Output: Output started successfully");
-                } else {
-                    blog(LOG_ERROR, "MXL Output: Failed to start output");
+            start_profile_output(global_mxl_output, "main");
+        }
+        
+        for (MXLConfig& profile : global_config->Profiles) {
+            if (!profile.OutputEnabled) {
+                continue;
+            }
+            flow_ids_assigned |= assign_missing_flow_ids(profile);
+            mxl_profile_output* entry = find_profile_output(profile.Name);
+            if (!entry) {
+                obs_output_t* output = create_profile_output(profile);
+                if (!output) {
+                    continue;
                 }
+                profile_outputs.push_back({profile.Name, output});
+                entry = &profile_outputs.back();
             }
+            start_profile_output(entry->output, profile.Name);
+        }
+        if (flow_ids_assigned) {
+            global_config->Save();
         }
     }
     
@@ -72,6 +169,20 @@ namespace {
             blog(LOG_INFO, "MXL Output: Stopping output");
             obs_output_stop(global_mxl_output);
         }
+        for (mxl_profile_output& entry : profile_outputs) {
+            stop_profile_output(entry.output);
+        }
+    }
+    
+    void mxl_output_release_all() {
+        if (global_mxl_output) {
+            obs_output_release(global_mxl_output);
+            global_mxl_output = nullptr;
+        }
+        for (mxl_profile_output& entry : profile_outputs) {
+            obs_output_release(entry.output);
+        }
+        profile_outputs.clear();
     }
     
     void apply_output_state_from_config() {
@@ -84,15 +195,28 @@ namespace {
             // Should be running - start if not already running
             if (!global_mxl_output || !obs_output_active(global_mxl_output)) {
                 blog(LOG_INFO, "MXL Output: Config enabled - starting output");
-                mxl_output_start_if_enabled();
             }
         } else {
             // Should be stopped - stop if currently running
             if (global_mxl_output && obs_output_active(global_mxl_output)) {
                 blog(LOG_INFO, "MXL Output: Config disabled - stopping output");
-                mxl_output_stop_global();
+                stop_profile_output(global_mxl_output);
             }
         }
+        
+        // Profiles that were disabled or removed from the config stop; their
+        // outputs are released on exit
+        for (mxl_profile_output& entry : profile_outputs) {
+            bool enabled = false;
+            for (const MXLConfig& profile : global_config->Profiles) {
+                enabled |= profile.Name == entry.name && profile.OutputEnabled;
+            }
+            if (!enabled && obs_output_active(entry.output)) {
+                blog(LOG_INFO, "MXL Output: Profile %s disabled - stopping output", entry.name.c_str());
+                stop_profile_output(entry.output);
+            }
+        }
+        mxl_output_start_if_enabled();
     }
     
     void show_mxl_status() {
@@ -109,12 +233,56 @@ namespace {
         blog(LOG_INFO, "Video Flow ID: %s", global_config->VideoFlowId.c_str());
         blog(LOG_INFO, "Audio Enabled: %s", global_config->AudioEnabled ? "Yes" : "No");
         blog(LOG_INFO, "Audio Flow ID: %s", global_config->AudioFlowId.c_str());
+        blog(LOG_INFO, "Audio Mixers: 0x%x (%s)%s%s", global_config->AudioMixers,
+             global_config->AudioLayout.c_str(),
+             global_config->AudioTrackFlowIds.empty() ? "" : ", track flows: ",
+             global_config->AudioTrackFlowIds.c_str());
+        blog(LOG_INFO, "Direct Grain Write: %s", global_config->DirectGrainWrite ? "Yes" : "No");
+        blog(LOG_INFO, "Video Queue: depth %d, drop %s", global_config->VideoQueueDepth,
+             global_config->VideoDropPolicy.c_str());
+        blog(LOG_INFO, "Conversion Threads: %d%s", global_config->ConversionThreads,
+             global_config->ConversionThreads <= 0 ? " (auto)" : "");
+        blog(LOG_INFO, "Video Conversion: %s", global_config->VideoConversion.c_str());
+        blog(LOG_INFO, "Video Media Type: %s", global_config->VideoMediaType.c_str());
+        blog(LOG_INFO, "Video Slice Batches: %d", global_config->VideoSliceBatches);
+        blog(LOG_INFO, "Video Gap Policy: %s", global_config->VideoGapPolicy.c_str());
+        blog(LOG_INFO, "Source: %s", global_config->Source.empty() ? "(program)" : global_config->Source.c_str());
+        blog(LOG_INFO, "Output Size: %dx%d%s", global_config->OutputWidth, global_config->OutputHeight,
+             global_config->OutputWidth > 0 && global_config->OutputHeight > 0 ? "" : " (OBS output size)");
+        if (global_config->ProxyScale > 1) {
+            blog(LOG_INFO, "Proxy: 1/%d, flow %s", global_config->ProxyScale, global_config->ProxyFlowId.c_str());
+        } else {
+            blog(LOG_INFO, "Proxy: disabled");
+        }
         
         if (global_mxl_output) {
             blog(LOG_INFO, "Output Status: %s", obs_output_active(global_mxl_output) ? "ACTIVE" : "STOPPED");
+            blog(LOG_INFO, "Dropped Frames: %d", obs_output_get_frames_dropped(global_mxl_output));
         } else {
             blog(LOG_INFO, "Output Status: NOT CREATED");
         }
+        
+        for (const MXLConfig& profile : global_config->Profiles) {
+            blog(LOG_INFO, "--- Profile %s ---", profile.Name.c_str());
+            blog(LOG_INFO, "Output Enabled: %s", profile.OutputEnabled ? "Yes" : "No");
+            blog(LOG_INFO, "Domain Path: %s", profile.DomainPath.c_str());
+            blog(LOG_INFO, "Source: %s", profile.Source.empty() ? "(program)" : profile.Source.c_str());
+            blog(LOG_INFO, "Video: %s, flow %s, size %dx%d%s", profile.VideoEnabled ? "Yes" : "No",
+                 profile.VideoFlowId.c_str(), profile.OutputWidth, profile.OutputHeight,
+                 profile.OutputWidth > 0 && profile.OutputHeight > 0 ? "" : " (OBS output size)");
+            blog(LOG_INFO, "Audio: %s, flow %s, mixers 0x%x (%s)", profile.AudioEnabled ? "Yes" : "No",
+                 profile.AudioFlowId.c_str(), profile.AudioMixers, profile.AudioLayout.c_str());
+            if (profile.ProxyScale > 1) {
+                blog(LOG_INFO, "Proxy: 1/%d, flow %s", profile.ProxyScale, profile.ProxyFlowId.c_str());
+            }
+            mxl_profile_output* entry = find_profile_output(profile.Name);
+            if (entry) {
+                blog(LOG_INFO, "Output Status: %s", obs_output_active(entry->output) ? "ACTIVE" : "STOPPED");
+                blog(LOG_INFO, "Dropped Frames: %d", obs_output_get_frames_dropped(entry->output));
+            } else {
+                blog(LOG_INFO, "Output Status: NOT CREATED");
+            }
+        }
         blog(LOG_INFO, "========================");
         blog(LOG_INFO, "Configuration file: %s", global_config->GetConfigPath().c_str());
         blog(LOG_INFO, "Edit the config file and restart OBS to change settings");
@@ -188,8 +356,8 @@ void mxl_output_settings_callback(void *data)
         }
         
         if (needs_restart) {
-            // Stop and destroy the current output completely
-            mxl_output_stop_global();
+            // Stop and destroy the main output completely; profile outputs keep running
+            stop_profile_output(global_mxl_output);
             if (global_mxl_output) {
                 obs_output_release(global_mxl_output);
                 global_mxl_output = nullptr;
@@ -203,6 +371,43 @@ void mxl_output_settings_callback(void *data)
     }
 }
 
+// Tools menu: start/stop the hot-path tracer
+void mxl_output_toggle_trace_callback(void *data)
+{
+    UNUSED_PARAMETER(data);
+    
+    bool enable = !mxl_trace_enabled();
+    if (enable) {
+        mxl_trace_clear();
+    }
+    mxl_trace_set_enabled(enable);
+    blog(LOG_INFO, "MXL Output: Hot-path tracing %s", enable ? "enabled" : "disabled");
+}
+
+// Tools menu: write the buffered trace events as Chrome trace JSON
+void mxl_output_dump_trace_callback(void *data)
+{
+    UNUSED_PARAMETER(data);
+    
+    char *path = obs_module_config_path("mxl-output-trace.json");
+    if (!path) {
+        return;
+    }
+    std::string trace_path(path);
+    bfree(path);
+    os_mkdirs(std::filesystem::path(trace_path).parent_path().string().c_str());
+    
+    int64_t events = mxl_trace_dump(trace_path, "obs-mxl-output-plugin");
+    if (events < 0) {
+        blog(LOG_ERROR, "MXL Output: Failed to write trace to %s", trace_path.c_str());
+        MXLNativeDialog::ShowMessage("MXL Output Trace", "Failed to write trace to " + trace_path);
+    } else {
+        blog(LOG_INFO, "MXL Output: Wrote %" PRId64 " trace events to %s", events, trace_path.c_str());
+        MXLNativeDialog::ShowMessage("MXL Output Trace",
+                                     "Wrote " + std::to_string(events) + " trace events to " + trace_path);
+    }
+}
+
 // Module load function
 MODULE_EXPORT bool obs_module_load(void)
 {
@@ -212,6 +417,12 @@ MODULE_EXPORT bool obs_module_load(void)
     global_config = MXLConfig::Current();
     global_config->Load();
     
+    // OBS_MXL_TRACE=1 starts the hot-path tracer at load time
+    if (getenv("OBS_MXL_TRACE")) {
+        mxl_trace_set_enabled(true);
+        blog(LOG_INFO, "MXL Output: Hot-path tracing enabled (OBS_MXL_TRACE)");
+    }
+    
     // Register the output type
     struct obs_output_info mxl_output_info = {};
     mxl_output_info.id = "mxl_raw_output";
@@ -239,6 +450,8 @@ MODULE_EXPORT bool obs_module_load(void)
     // Add Tools menu item
     blog(LOG_INFO, "MXL Output: Adding Tools menu item");
     obs_frontend_add_tools_menu_item("MXL Output Settings", mxl_output_settings_callback, nullptr);
+    obs_frontend_add_tools_menu_item("MXL Output: Start/Stop Trace", mxl_output_toggle_trace_callback, nullptr);
+    obs_frontend_add_tools_menu_item("MXL Output: Dump Trace", mxl_output_dump_trace_callback, nullptr);
     blog(LOG_INFO, "MXL Output: Tools menu items added successfully");
     
     // Add frontend event callback
@@ -251,17 +464,14 @@ MODULE_EXPORT bool obs_module_load(void)
             // Add a small delay to ensure registration is complete
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
             
-            if (global_config && global_config->OutputEnabled) {
-                blog(LOG_INFO, "MXL Output: Auto-starting output");
+            if (global_config) {
+                blog(LOG_INFO, "MXL Output: Auto-starting enabled outputs");
                 mxl_output_start_if_enabled();
             }
         } else if (event == OBS_FRONTEND_EVENT_EXIT) {
             blog(LOG_INFO, "MXL Output: OBS exiting, stopping output");
             mxl_output_stop_global();
-            if (global_mxl_output) {
-                obs_output_release(global_mxl_output);
-                global_mxl_output = nullptr;
-            }
+            mxl_output_release_all();
         }
     }, nullptr);
     
@@ -277,11 +487,8 @@ void obs_module_unload(void)
     // Stop output if running
     mxl_output_stop_global();
     
-    // Clean up global output
-    if (global_mxl_output) {
-        obs_output_release(global_mxl_output);
-        global_mxl_output = nullptr;
-    }
+    // Clean up all outputs
+    mxl_output_release_all();
     
     blog(LOG_INFO, "MXL Output Plugin unloaded");
 }